@@ -25,7 +25,9 @@ void periodicTask()
 
     // Use virtual hardware
     auto &hal = edurtos::drivers::HAL::getInstance();
-    hal.getUART().transmit("Periodic task tick: " + std::to_string(counter));
+    // write() only queues; transmit() would hold the dispatcher for the wire time
+    std::string tick = "Periodic task tick: " + std::to_string(counter);
+    hal.getUART().write(tick.data(), tick.size());
 
     // Simulate some work
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
@@ -103,6 +105,8 @@ int main()
 
     // Configure virtual hardware
     hal.getGPIO().setPinMode(5, edurtos::drivers::VirtualGPIO::PinMode::OUTPUT); // LED pin
+    hal.getGPIO().setConsoleEcho(true);
+    hal.getUART().setConsoleEcho(true);
     hal.getUART().configure(edurtos::drivers::VirtualUART::BaudRate::BAUD_115200);
 
     // Get RTOS kernel instance
@@ -111,6 +115,9 @@ int main()
     // Initialize kernel
     kernel.initialize();
 
+    // Dispatch on the CPU that services virtual interrupts, so they preempt tasks
+    kernel.getScheduler()->setCpuAffinity(hal.getInterruptController().getCpu());
+
     // Create scheduler logger
     edurtos::util::SchedulerLogger logger(*kernel.getScheduler());
     logger.start();
@@ -0,0 +1,110 @@
+#include "../include/kernel/scheduler.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Dispatch overhead of the scheduler configurations, in two parts:
+//   decision - popping the next task from the configuration's ready queue and
+//              requeueing it, i.e. the selection itself (best of several rounds)
+//   job      - a full runUntil() dispatch of a trivial job from this thread,
+//              which adds the clock, CPU-time and statistics work of runJob()
+
+using namespace edurtos;
+
+namespace
+{
+    constexpr std::size_t TASK_COUNT = 32;
+    constexpr auto RUN_TIME = std::chrono::milliseconds(500);
+    constexpr std::size_t DECISIONS = 1000000;
+    constexpr int DECISION_ROUNDS = 5;
+
+    // Best ns per pop+push over the given tasks
+    template <typename QueueType>
+    double measureDecision(const std::vector<TaskPtr> &tasks)
+    {
+        QueueType queue;
+        for (const auto &task : tasks)
+        {
+            queue.push(*task);
+        }
+
+        double best = 0;
+        for (int round = 0; round < DECISION_ROUNDS; ++round)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < DECISIONS; ++i)
+            {
+                Task *task = queue.pop();
+                queue.push(*task);
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            double per_decision = static_cast<double>(elapsed.count()) / DECISIONS;
+            if (round == 0 || per_decision < best)
+            {
+                best = per_decision;
+            }
+        }
+        return best;
+    }
+
+    template <typename SchedulerType>
+    void runBenchmark(const std::string &name)
+    {
+        SchedulerType scheduler;
+
+        std::vector<TaskPtr> tasks;
+        std::size_t handled = 0;
+        for (std::size_t i = 0; i < TASK_COUNT; ++i)
+        {
+            // Spread priorities and deadlines so both queue kinds have to order
+            auto task = std::make_shared<Task>(
+                "bench_" + std::to_string(i),
+                [&handled]
+                { ++handled; },
+                static_cast<std::uint8_t>(10 + (i * 7) % 80),
+                SchedulePolicy::PREEMPTIVE,
+                std::chrono::milliseconds(0),
+                std::chrono::milliseconds(1 + i % 10));
+            tasks.push_back(task);
+        }
+
+        // Before addTask(): a task can only sit in one queue at a time
+        double decision_ns = measureDecision<typename SchedulerType::queue_type>(tasks);
+        for (const auto &task : tasks)
+        {
+            scheduler.addTask(task);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t jobs = scheduler.runUntil(start + RUN_TIME);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        double seconds = elapsed.count() / 1e9;
+        std::cout << std::left << std::setw(36) << name
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << decision_ns << " ns/decision"
+                  << std::setw(12) << static_cast<std::size_t>(jobs / seconds) << " jobs/s"
+                  << std::setw(8) << (jobs ? elapsed.count() / static_cast<long long>(jobs) : 0) << " ns/job"
+                  << "  (" << handled << " handler calls)\n";
+    }
+}
+
+int main()
+{
+    std::cout << "EduRTOS Scheduler Benchmark\n";
+    std::cout << "---------------------------\n";
+    std::cout << TASK_COUNT << " trivial tasks, " << RUN_TIME.count() << " ms per configuration\n\n";
+
+    runBenchmark<Scheduler>("ReadyQueue, runtime mode, mutex");
+    runBenchmark<BasicScheduler<ReadyQueue, NoPreemption, NoLock>>("ReadyQueue, no preemption, no lock");
+    runBenchmark<BasicScheduler<EdfQueue, RuntimePreemption, MutexLock>>("EdfQueue, runtime mode, mutex");
+    runBenchmark<BasicScheduler<EdfQueue, NoPreemption, NoLock>>("EdfQueue, no preemption, no lock");
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../kernel/latency_histogram.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace edurtos
+{
+    namespace drivers
+    {
+
+        struct InterruptLineStatistics
+        {
+            std::uint64_t raised = 0;
+            std::uint64_t serviced = 0;
+            std::uint64_t coalesced = 0; // Raised while already pending
+            LatencyHistogram latency;    // Raise to handler entry
+            std::chrono::nanoseconds average_handler_time{0};
+            std::chrono::nanoseconds max_handler_time{0};
+        };
+
+        // Virtual nested vectored interrupt controller. Numbered IRQ lines
+        // each have a handler, a priority, an enable bit and a pending bit.
+        // raise() only sets the pending bit, so it is lock-free and callable
+        // from any thread; raises while the line is pending coalesce, as on
+        // hardware.
+        //
+        // Handlers run on one service thread per priority level. All service
+        // threads are pinned to one host CPU and ask for real-time (FIFO)
+        // priority by level, so on that CPU a higher level preempts a lower
+        // level's handler and any task, as on a single core. Pin the
+        // scheduler's dispatcher to the same CPU for interrupts to preempt
+        // task execution. Without real-time priority (hasRealtimePriority(); on
+        // Windows the process must run in REALTIME_PRIORITY_CLASS) the levels
+        // are time-shared with each other and with tasks, and do not nest. Within a level lines are taken lowest number first.
+        // Higher priority values are more urgent, as for tasks.
+        class VirtualInterruptController
+        {
+        public:
+            static constexpr std::size_t IRQ_COUNT = 32;
+            static constexpr std::uint8_t PRIORITY_LEVELS = 8; // Priorities 0-7
+
+            using Handler = std::function<void()>;
+
+            VirtualInterruptController() = default;
+            ~VirtualInterruptController();
+
+            VirtualInterruptController(const VirtualInterruptController &) = delete;
+            VirtualInterruptController &operator=(const VirtualInterruptController &) = delete;
+
+            void start();
+            void stop();
+            bool isRunning() const { return running_; }
+
+            // False if the host refused real-time priority for the service
+            // threads; they then compete with tasks as normal threads
+            bool hasRealtimePriority() const { return realtime_; }
+
+            // Host CPU of the service threads (default 0, -1 for any)
+            void setCpu(int cpu);
+            int getCpu() const { return cpu_; }
+
+            // Line configuration. Out of range IRQ numbers throw std::out_of_range.
+            void setHandler(std::uint8_t irq, Handler handler);
+            void setPriority(std::uint8_t irq, std::uint8_t priority);
+            std::uint8_t getPriority(std::uint8_t irq) const;
+            void enable(std::uint8_t irq);
+            void disable(std::uint8_t irq); // Raises still set the pending bit
+            bool isEnabled(std::uint8_t irq) const;
+
+            void raise(std::uint8_t irq);
+            void clearPending(std::uint8_t irq);
+            bool isPending(std::uint8_t irq) const;
+            std::uint32_t getPendingMask() const { return pending_; }
+
+            // Global mask, nestable. Outside a handler, disableInterrupts()
+            // also waits for running handlers to return, so the caller's
+            // critical section never overlaps one.
+            void disableInterrupts();
+            void enableInterrupts();
+
+            // Lines with a lower priority stay pending (0 masks none)
+            void setPriorityThreshold(std::uint8_t threshold);
+            std::uint8_t getPriorityThreshold() const { return threshold_; }
+
+            // True on a service thread while it runs a handler
+            static bool inInterrupt() { return in_interrupt_; }
+
+            // Handlers entered and not yet returned; with real-time priority
+            // on one CPU these are nested, each preempting the one below
+            std::size_t getNestingDepth() const;
+            std::size_t getMaxNestingDepth() const { return max_nesting_; }
+
+            InterruptLineStatistics getStatistics(std::uint8_t irq) const;
+            void resetStatistics();
+
+        private:
+            struct Line
+            {
+                std::atomic<std::shared_ptr<const Handler>> handler;
+                std::atomic<std::uint8_t> priority{0};
+                std::atomic<std::int64_t> raise_time_ns{0}; // Of the raise that set the pending bit
+                std::atomic<std::uint64_t> raised{0};
+                std::atomic<std::uint64_t> coalesced{0};
+
+                // Guarded by statistics_mutex_
+                InterruptLineStatistics statistics;
+                std::chrono::nanoseconds total_handler_time{0};
+            };
+
+            std::array<Line, IRQ_COUNT> lines_;
+            std::atomic<std::uint32_t> pending_{0};
+            std::atomic<std::uint32_t> enabled_{0};
+
+            // Bumped to wake a level's service thread
+            std::array<std::atomic<std::uint32_t>, PRIORITY_LEVELS> level_signals_{};
+            std::atomic<std::uint32_t> active_levels_{0}; // Bit per level inside a handler
+            std::atomic<int> active_handlers_{0};
+            std::atomic<int> disable_count_{0};
+            std::atomic<std::uint8_t> threshold_{0};
+            std::atomic<std::size_t> max_nesting_{0};
+
+            std::vector<std::thread> service_threads_;
+            std::atomic<bool> running_{false};
+            std::atomic<bool> realtime_{false};
+            std::atomic<int> cpu_{0};
+            std::atomic<std::uint32_t> cpu_generation_{0}; // Bumped by setCpu()
+            mutable std::mutex statistics_mutex_;
+
+            static thread_local bool in_interrupt_;
+
+            void serviceLoop(std::uint8_t level);
+            void pinServiceThread();
+            bool serviceLevel(std::uint8_t level);
+            void signalLevel(std::uint8_t level);
+            void signalAllLevels();
+            static void checkIrq(std::uint8_t irq);
+        };
+
+    } // namespace drivers
+} // namespace edurtos
@@ -1,22 +1,37 @@
 #pragma once
 
+#include "../kernel/task.hpp"
+#include "../kernel/stream_buffer.hpp"
+#include "interrupt_controller.hpp"
 #include <cstdint>
 #include <array>
 #include <string>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 namespace edurtos
 {
     namespace drivers
     {
 
-        // Virtual GPIO Device
+        // Virtual GPIO Device. Pin levels live in one atomic port word, so
+        // whole-port reads and writes are single atomic operations and safe
+        // from any thread. Every level change is compared against the old
+        // port value (XOR) to find rising and falling edges, which raise the
+        // interrupts armed for them.
         class VirtualGPIO
         {
         public:
             static constexpr std::size_t PIN_COUNT = 16;
 
+            // Bit n is pin n
+            using PinMask = std::uint32_t;
+            static constexpr PinMask ALL_PINS = (PinMask{1} << PIN_COUNT) - 1;
+
             enum class PinMode
             {
                 INPUT,
@@ -25,44 +40,225 @@ namespace edurtos
                 INPUT_PULLDOWN
             };
 
+            enum class Edge
+            {
+                RISING,
+                FALLING,
+                BOTH
+            };
+
             VirtualGPIO();
             void setPinMode(std::uint8_t pin, PinMode mode);
+            PinMode getPinMode(std::uint8_t pin) const;
             void writePin(std::uint8_t pin, bool value);
             bool readPin(std::uint8_t pin) const;
+
+            // Port access. Writes only change pins in OUTPUT mode; the others
+            // are masked off.
+            PinMask readPort() const { return port_.load(std::memory_order_acquire); }
+            PinMask getOutputMask() const { return output_mask_.load(std::memory_order_relaxed); }
+            void writePort(PinMask value);
+            void setBits(PinMask mask);
+            void clearBits(PinMask mask);
+            void toggleBits(PinMask mask);
+            void modifyPort(PinMask clear_mask, PinMask set_mask); // Clear, then set, in one step
+
+            // Arms the pin's interrupt for both edges; a null handler disarms it
             void registerInterrupt(std::uint8_t pin, std::function<void()> handler);
 
+            // Interrupt that notifies `task` directly; the task is not kept alive
+            void registerInterrupt(std::uint8_t pin, const TaskPtr &task,
+                                   NotifyAction action = NotifyAction::INCREMENT,
+                                   std::uint32_t value = 0);
+
+            // Edges that raise the pin's interrupt once registered
+            void setInterruptEdge(std::uint8_t pin, Edge edge);
+
+            // Drive input pins from outside; level changes raise the pins'
+            // interrupts (on the calling thread without a controller)
+            void setInputLevel(std::uint8_t pin, bool level);
+            void setInputLevels(PinMask mask, PinMask levels);
+
+            // Route pin interrupts through `controller`, pin n on IRQ first_irq + n
+            void attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq);
+
+            // Print output changes to stdout (off by default)
+            void setConsoleEcho(bool enabled) { console_echo_ = enabled; }
+
         private:
             std::array<PinMode, PIN_COUNT> pin_modes_;
-            std::array<bool, PIN_COUNT> pin_states_;
+            std::atomic<PinMask> port_{0};
+            std::atomic<PinMask> output_mask_{0};
+            std::atomic<PinMask> rising_mask_{0};  // Pins with an interrupt on rising edges
+            std::atomic<PinMask> falling_mask_{0}; // Pins with an interrupt on falling edges
+            std::array<Edge, PIN_COUNT> edges_;
             std::array<std::function<void()>, PIN_COUNT> interrupt_handlers_;
+            VirtualInterruptController *controller_{nullptr};
+            std::uint8_t first_irq_{0};
+            std::atomic<bool> console_echo_{false};
+
+            void updateOutputs(PinMask old_value, PinMask new_value);
+            void dispatchEdges(PinMask old_value, PinMask new_value);
+            void armInterrupt(std::uint8_t pin);
+            static void checkPin(std::uint8_t pin);
         };
 
-        // Virtual Timer Device
+        struct TimerChannelStatistics
+        {
+            std::uint64_t expiries = 0;
+            std::uint64_t missed = 0;   // Periods skipped because expiry ran too late
+            std::uint64_t captures = 0;
+            LatencyHistogram lateness;  // Actual minus ideal expiry time (jitter)
+        };
+
+        // Virtual Timer Device. One free-running counter (ns since the timer
+        // was created) and CHANNEL_COUNT channels, each with a compare
+        // register (next expiry, in counter time), an auto-reload register
+        // (period) and a capture register.
+        //
+        // All channels share one host timer: a thread sleeping on a timerfd
+        // (Linux) until the earliest compare value, or, with
+        // ClockSource::VIRTUAL, no thread at all and time moved by advance().
+        // Periodic channels reload from their ideal expiry, not from when
+        // they ran, so lateness does not accumulate. Expiries raise the
+        // channel's IRQ on the attached controller, which runs the callback;
+        // without one the callback runs on the timer thread.
+        //
+        // The single-channel API from before (start/stop/registerCallback)
+        // drives channel 0.
         class VirtualTimer
         {
         public:
+            static constexpr std::size_t CHANNEL_COUNT = 4;
+
             enum class TimerMode
             {
                 ONE_SHOT,
-                PERIODIC
+                PERIODIC,
+                INPUT_CAPTURE // capture() latches the counter and raises the IRQ
             };
 
-            VirtualTimer();
+            enum class ClockSource
+            {
+                HOST,
+                VIRTUAL
+            };
+
+            explicit VirtualTimer(ClockSource clock = ClockSource::HOST);
+            ~VirtualTimer();
+
+            VirtualTimer(const VirtualTimer &) = delete;
+            VirtualTimer &operator=(const VirtualTimer &) = delete;
+
+            // Channel 0
             void start(std::uint32_t interval_ms, TimerMode mode);
             void stop();
             bool isRunning() const;
             void registerCallback(std::function<void()> callback);
-            void update(); // Should be called periodically by the scheduler
+
+            // Expiry notifies `task` directly; the task is not kept alive
+            void registerCallback(const TaskPtr &task,
+                                  NotifyAction action = NotifyAction::INCREMENT,
+                                  std::uint32_t value = 0);
+
+            // Kept for existing callers; expiries no longer need polling
+            void update() {}
+
+            // Channels. Out of range channel numbers throw std::out_of_range.
+            // A periodic channel first expires after `interval`, then every
+            // auto-reload period, which start sets to `interval`.
+            void startChannel(std::size_t channel, std::chrono::nanoseconds interval, TimerMode mode);
+            void stopChannel(std::size_t channel);
+            bool isChannelRunning(std::size_t channel) const;
+            void setChannelCallback(std::size_t channel, std::function<void()> callback);
+            void setCompare(std::size_t channel, std::chrono::nanoseconds counter_value);
+            std::chrono::nanoseconds getCompare(std::size_t channel) const;
+            void setAutoReload(std::size_t channel, std::chrono::nanoseconds period); // 0 stops after the next expiry
+            std::chrono::nanoseconds getAutoReload(std::size_t channel) const;
+
+            // Input capture: callable from any thread, e.g. a GPIO interrupt
+            // handler. Ignored unless the channel is in INPUT_CAPTURE mode.
+            void capture(std::size_t channel);
+            std::chrono::nanoseconds getCapture(std::size_t channel) const;
+            std::function<void()> captureHandler(std::size_t channel)
+            {
+                return [this, channel]()
+                { capture(channel); };
+            }
+
+            std::chrono::nanoseconds getCounter() const;
+            ClockSource getClockSource() const { return clock_; }
+
+            // Virtual clock only: move time forward, expiring channels in
+            // order on the calling thread. False with the host clock.
+            bool advance(std::chrono::nanoseconds duration);
+
+            TimerChannelStatistics getStatistics(std::size_t channel) const;
+            void resetStatistics();
+
+            // Channel n raises `first_irq` + n on `controller`, which runs its callback
+            void attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq);
 
         private:
-            std::atomic<bool> running_{false};
-            std::uint32_t interval_ms_{0};
-            TimerMode mode_{TimerMode::ONE_SHOT};
-            std::function<void()> callback_;
-            std::uint64_t last_trigger_time_{0};
+            struct Channel
+            {
+                TimerMode mode{TimerMode::ONE_SHOT};
+                bool running{false};
+                std::chrono::nanoseconds compare{0};
+                std::chrono::nanoseconds reload{0};
+                std::chrono::nanoseconds captured{0};
+                std::function<void()> callback;
+                TimerChannelStatistics statistics;
+            };
+
+            ClockSource clock_;
+            std::chrono::steady_clock::time_point epoch_; // Counter zero
+            std::atomic<std::int64_t> virtual_now_ns_{0};
+
+            mutable std::mutex mutex_;
+            std::array<Channel, CHANNEL_COUNT> channels_;
+            VirtualInterruptController *controller_{nullptr};
+            std::uint8_t first_irq_{0};
+
+            std::thread thread_;
+            std::atomic<bool> thread_running_{false};
+            int timer_fd_{-1};
+            std::condition_variable rearm_; // Without timerfd
+
+            void startThread();
+            void threadLoop();
+            void armHostTimer(); // Caller holds mutex_
+            std::chrono::nanoseconds nextExpiry() const; // Caller holds mutex_; -1 when none
+            void expire(std::chrono::nanoseconds now);
+            void dispatch(std::size_t channel);
+            static void checkChannel(std::size_t channel);
+        };
+
+        struct UartStatistics
+        {
+            std::uint64_t tx_bytes = 0;    // Shifted out on the line
+            std::uint64_t rx_bytes = 0;    // Arrived from the line or injectReceive()
+            std::uint64_t rx_overruns = 0; // Arrived with the RX FIFO full
+            std::uint64_t tx_dropped = 0;  // Refused by the host backing
+            std::uint64_t tx_dma_transfers = 0;
+            std::uint64_t rx_dma_transfers = 0;
+            std::size_t tx_fifo_level = 0;
+            std::size_t rx_fifo_level = 0;
+            std::size_t tx_fifo_peak = 0;
+            std::size_t rx_fifo_peak = 0;
+            double tx_bytes_per_second = 0; // Since the last reset
+            double rx_bytes_per_second = 0;
         };
 
-        // Virtual UART Device
+        // Virtual UART Device. TX and RX FIFOs are lock-free stream buffers;
+        // a line thread moves bytes between them and the wire at the
+        // configured baud rate, 10 bits per character (8N1), in both
+        // directions at once. The wire is a host pseudo-terminal or files
+        // when attached, so local tools can talk to the device; otherwise
+        // transmitted bytes are only counted (and echoed if enabled).
+        //
+        // DMA-style transfers move a caller's buffer over the line without
+        // the FIFOs and raise a completion interrupt at the end.
         class VirtualUART
         {
         public:
@@ -75,33 +271,161 @@ namespace edurtos
                 BAUD_115200
             };
 
+            static constexpr std::size_t RX_BUFFER_SIZE = 4096;
+            static constexpr std::size_t TX_BUFFER_SIZE = 4096;
+            static constexpr std::uint32_t BITS_PER_CHARACTER = 10; // Start, 8 data, stop
+
             VirtualUART();
+            ~VirtualUART();
+
+            VirtualUART(const VirtualUART &) = delete;
+            VirtualUART &operator=(const VirtualUART &) = delete;
+
             void configure(BaudRate baud_rate);
+            std::uint32_t getBaudRate() const; // Bits per second
+            std::chrono::nanoseconds getCharacterTime() const;
+
+            // Queue everything and wait until it has left the line. Blocks for
+            // the wire time (about 87 us per byte at 115200 baud) plus up to a
+            // line tick; task handlers should use write() instead.
             void transmit(const std::string &data);
+
+            // Drain the whole RX buffer into a string
             std::string receive();
             bool hasData() const;
 
+            // TX path (one writer task). Returns the bytes queued; a short count
+            // means the TX FIFO is full until the line drains it.
+            std::size_t write(const void *data, std::size_t length);
+            void flush(); // Wait until the TX FIFO and any TX DMA are done
+            void update() {} // Kept for existing callers; the line thread sends
+
+            // RX path (one reader task). Copies straight out of the RX buffer.
+            std::size_t read(void *data, std::size_t max_length);
+
+            // Notify `task` once `trigger_level` received bytes are waiting; the
+            // task's handler calls waitForData() to block for the next batch
+            void setReceiveNotify(const TaskPtr &task, std::size_t trigger_level = 1);
+            bool waitForData() { return rx_buffer_.waitForData(); }
+
+            // Line side of RX, delivered at once. Bytes that do not fit are
+            // dropped and counted as overruns; any arrival raises the receive
+            // interrupt (or fills an armed receive DMA).
+            std::size_t injectReceive(const void *data, std::size_t length);
+
+            // Line side of RX at the baud rate: bytes queue on the wire and
+            // arrive one character time apart
+            void feedLine(const void *data, std::size_t length);
+
+            // DMA transfers. The buffer must stay valid until the completion
+            // interrupt; false while a transfer in that direction is running.
+            // Bytes already queued with write() go out first.
+            bool transmitDma(const void *data, std::size_t length);
+            bool receiveDma(void *buffer, std::size_t length);
+            bool isTransmitDmaBusy() const;
+            bool isReceiveDmaBusy() const;
+            std::size_t cancelReceiveDma(); // Returns the bytes received so far
+
+            // Host backing. openPseudoTerminal() returns the path for tools
+            // such as screen or minicom ("" on failure); openFiles() reads the
+            // wire from `rx_path` and writes it to `tx_path` (either may be
+            // empty; a named pipe suits rx_path).
+            std::string openPseudoTerminal();
+            bool openFiles(const std::string &rx_path, const std::string &tx_path);
+            void closeHostBacking();
+
+            // Print transmitted data to stdout once the line goes idle (off by default)
+            void setConsoleEcho(bool enabled) { console_echo_ = enabled; }
+
+            // Handlers run from the controller's service thread if one is
+            // attached, else on the thread that caused the event
+            void registerReceiveInterrupt(std::function<void()> handler);
+            void registerTransmitDmaInterrupt(std::function<void()> handler);
+            void registerReceiveDmaInterrupt(std::function<void()> handler);
+
+            // Receive on `first_irq`, TX DMA completion on + 1, RX DMA completion on + 2
+            void attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq);
+            std::size_t getOverrunCount() const { return rx_overruns_; }
+
+            UartStatistics getStatistics() const;
+            void resetStatistics();
+
+            StreamBuffer &getReceiveBuffer() { return rx_buffer_; }
+            StreamBuffer &getTransmitBuffer() { return tx_buffer_; }
+
         private:
-            BaudRate baud_rate_{BaudRate::BAUD_115200};
-            std::string receive_buffer_;
+            enum Interrupt : std::uint8_t
+            {
+                RECEIVE,
+                TRANSMIT_DMA,
+                RECEIVE_DMA,
+                INTERRUPT_COUNT
+            };
+
+            std::atomic<BaudRate> baud_rate_{BaudRate::BAUD_115200};
+            StreamBuffer rx_buffer_{RX_BUFFER_SIZE};
+            StreamBuffer tx_buffer_{TX_BUFFER_SIZE};
+            std::atomic<std::size_t> rx_overruns_{0};
+            std::array<std::function<void()>, INTERRUPT_COUNT> handlers_;
+            VirtualInterruptController *controller_{nullptr};
+            std::uint8_t first_irq_{0};
+            std::atomic<bool> console_echo_{false};
+
+            // Line state, guarded by line_mutex_
+            mutable std::mutex line_mutex_;
+            std::condition_variable line_wake_;  // Work for the line thread
+            std::condition_variable tx_drained_; // TX FIFO and DMA empty
+            std::thread line_thread_;
+            bool line_running_{false};
+            std::chrono::nanoseconds tx_credit_{0}; // Line time not yet spent on characters
+            std::chrono::nanoseconds rx_credit_{0};
+            const std::byte *tx_dma_data_{nullptr};
+            std::size_t tx_dma_remaining_{0};
+            std::byte *rx_dma_data_{nullptr};
+            std::size_t rx_dma_length_{0};
+            std::size_t rx_dma_received_{0};
+            std::string rx_wire_; // Fed with feedLine(), not yet arrived
+            std::string console_line_;
+            int host_rx_fd_{-1};
+            int host_tx_fd_{-1};
+            int host_slave_fd_{-1}; // Keeps a pseudo-terminal open without a client
+            UartStatistics statistics_;
+            std::chrono::steady_clock::time_point statistics_start_;
+
+            void lineLoop();
+            std::uint32_t shiftLine(std::chrono::nanoseconds elapsed); // Returns interrupt bits
+            void sendToWire(const std::byte *data, std::size_t length);
+            std::uint32_t deliverReceive(const std::byte *data, std::size_t length);
+            bool transmitIdle() const;
+            void raiseInterrupts(std::uint32_t interrupts);
+            void setInterrupt(Interrupt line, std::function<void()> handler);
         };
 
         // Hardware abstraction layer that collects all virtual devices
         class HAL
         {
         public:
+            // IRQ lines of the devices
+            static constexpr std::uint8_t IRQ_GPIO_BASE = 0; // One per pin
+            static constexpr std::uint8_t IRQ_TIMER = IRQ_GPIO_BASE + VirtualGPIO::PIN_COUNT; // One per channel
+            static constexpr std::uint8_t IRQ_UART_RX = IRQ_TIMER + VirtualTimer::CHANNEL_COUNT;
+            static constexpr std::uint8_t IRQ_UART_TX_DMA = IRQ_UART_RX + 1;
+            static constexpr std::uint8_t IRQ_UART_RX_DMA = IRQ_UART_RX + 2;
+
             static HAL &getInstance();
 
+            VirtualInterruptController &getInterruptController();
             VirtualGPIO &getGPIO();
             VirtualTimer &getTimer();
             VirtualUART &getUART();
 
         private:
             HAL();
-            ~HAL() = default;
+            ~HAL();
             HAL(const HAL &) = delete;
             HAL &operator=(const HAL &) = delete;
 
+            VirtualInterruptController interrupt_controller_; // Outlives the devices
             VirtualGPIO gpio_;
             VirtualTimer timer_;
             VirtualUART uart_;
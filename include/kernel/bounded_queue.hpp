@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace edurtos
+{
+    // Bounded lock-free multi-producer/multi-consumer queue (Vyukov). Storage is
+    // allocated once at construction; push and pop never block or allocate, so
+    // they may be used from signal handlers and virtual interrupt handlers.
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit BoundedQueue(std::size_t capacity)
+        {
+            capacity_ = 2;
+            while (capacity_ < capacity)
+            {
+                capacity_ <<= 1;
+            }
+            mask_ = capacity_ - 1;
+
+            cells_ = std::make_unique<Cell[]>(capacity_);
+            for (std::size_t i = 0; i < capacity_; i++)
+            {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // Returns false instead of waiting when the queue is full
+        bool tryPush(const T &value)
+        {
+            std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;)
+            {
+                cell = &cells_[position & mask_];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0)
+                {
+                    if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false; // Full
+                }
+                else
+                {
+                    position = enqueue_position_.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = value;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(T &value)
+        {
+            std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;)
+            {
+                cell = &cells_[position & mask_];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+                if (difference == 0)
+                {
+                    if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false; // Empty
+                }
+                else
+                {
+                    position = dequeue_position_.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = cell->value;
+            cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate while producers or consumers are active
+        std::size_t size() const
+        {
+            std::size_t enqueued = enqueue_position_.load(std::memory_order_relaxed);
+            std::size_t dequeued = dequeue_position_.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        bool empty() const { return size() == 0; }
+        std::size_t capacity() const { return capacity_; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence{0};
+            T value{};
+        };
+
+        std::size_t capacity_;
+        std::size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        // Keep producer and consumer positions on separate cache lines
+        alignas(64) std::atomic<std::size_t> enqueue_position_{0};
+        alignas(64) std::atomic<std::size_t> dequeue_position_{0};
+    };
+
+} // namespace edurtos
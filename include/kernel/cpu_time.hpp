@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+
+namespace edurtos
+{
+    // CPU time consumed so far by the calling thread. Unlike steady_clock this
+    // does not advance while the thread sleeps, blocks or is preempted by the host.
+    std::chrono::nanoseconds threadCpuTime();
+
+    // Block the calling thread until `deadline` with microsecond accuracy.
+    // Host sleeps overshoot by tens of microseconds, so this sleeps to just
+    // before the deadline and spins the rest.
+    void sleepUntil(std::chrono::steady_clock::time_point deadline);
+
+} // namespace edurtos
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "cpu_time.hpp"
+#include "task.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+namespace edurtos
+{
+    // One entry of a compile-time task set. Like TaskBase, the deadline
+    // defaults to the period and priorities run 1-99; here the priority only
+    // breaks ties between jobs with the same deadline.
+    struct StaticTask
+    {
+        const char *name;
+        void (*handler)();
+        std::uint32_t period_us;
+        std::uint32_t wcet_us;
+        std::uint32_t deadline_us = 0; // 0 = period
+        std::uint8_t priority = 50;
+
+        constexpr std::uint32_t getDeadline() const { return deadline_us ? deadline_us : period_us; }
+    };
+
+    // Cyclic executive for a task set fixed at compile time:
+    //
+    //     void readSensor();
+    //     void control();
+    //     inline constexpr std::array tasks = {
+    //         StaticTask{"sensor", &readSensor, 10000, 2000},
+    //         StaticTask{"control", &control, 20000, 5000},
+    //     };
+    //     CyclicExecutive<tasks> executive;   // Fails to compile if unschedulable
+    //     executive.run();
+    //
+    // The dispatch table for one hyperperiod is produced by constexpr
+    // evaluation of non-preemptive EDF, and the build fails if any job would
+    // miss its deadline. At run time the executive only walks the table: no
+    // scheduling decisions, no locks and no allocation.
+    template <const auto &Tasks>
+    class CyclicExecutive
+    {
+    public:
+        static constexpr std::size_t TASK_COUNT = std::size(Tasks);
+        static constexpr std::size_t MAX_TABLE_SIZE = 4096;
+
+        struct Entry
+        {
+            std::uint64_t start_us;    // Offset into the hyperperiod
+            std::uint64_t deadline_us; // Absolute within the hyperperiod
+            std::uint32_t task;        // Index into Tasks
+        };
+
+    private:
+        static constexpr bool isValidTaskSet()
+        {
+            for (const StaticTask &task : Tasks)
+            {
+                if (task.handler == nullptr || task.period_us == 0 || task.wcet_us == 0 ||
+                    task.getDeadline() > task.period_us)
+                {
+                    return false;
+                }
+            }
+            return TASK_COUNT > 0;
+        }
+
+        static_assert(isValidTaskSet(),
+                      "Every static task needs a handler, a period, a WCET and a deadline no longer than its period");
+
+        static constexpr std::uint64_t computeHyperperiod()
+        {
+            std::uint64_t hyperperiod = 1;
+            for (const StaticTask &task : Tasks)
+            {
+                hyperperiod = std::lcm(hyperperiod, std::uint64_t{task.period_us});
+            }
+            return hyperperiod;
+        }
+
+        static constexpr std::size_t countJobs()
+        {
+            std::size_t jobs = 0;
+            for (const StaticTask &task : Tasks)
+            {
+                jobs += computeHyperperiod() / task.period_us;
+            }
+            return jobs;
+        }
+
+    public:
+        static constexpr std::uint64_t HYPERPERIOD_US = computeHyperperiod();
+        static constexpr std::size_t JOB_COUNT = countJobs();
+
+        static_assert(JOB_COUNT <= MAX_TABLE_SIZE,
+                      "Hyperperiod has too many jobs; make the periods harmonic");
+
+        struct Table
+        {
+            std::array<Entry, JOB_COUNT> entries{};
+            bool feasible = true;
+        };
+
+    private:
+        // Non-preemptive EDF over one hyperperiod, all tasks released at 0
+        static constexpr Table buildTable()
+        {
+            Table table;
+            std::array<std::uint64_t, TASK_COUNT> completed{};
+            std::uint64_t time = 0;
+
+            for (std::size_t n = 0; n < JOB_COUNT;)
+            {
+                std::size_t best = TASK_COUNT;
+                std::uint64_t best_deadline = 0;
+                std::uint64_t next_release = UINT64_MAX;
+
+                for (std::size_t i = 0; i < TASK_COUNT; i++)
+                {
+                    const StaticTask &task = Tasks[i];
+                    if (completed[i] == HYPERPERIOD_US / task.period_us)
+                    {
+                        continue;
+                    }
+
+                    std::uint64_t release = completed[i] * task.period_us;
+                    if (release > time)
+                    {
+                        next_release = release < next_release ? release : next_release;
+                        continue;
+                    }
+
+                    std::uint64_t deadline = release + task.getDeadline();
+                    if (best == TASK_COUNT || deadline < best_deadline ||
+                        (deadline == best_deadline && task.priority > Tasks[best].priority))
+                    {
+                        best = i;
+                        best_deadline = deadline;
+                    }
+                }
+
+                if (best == TASK_COUNT)
+                {
+                    time = next_release; // Idle until the next release
+                    continue;
+                }
+
+                table.entries[n++] = Entry{time, best_deadline, static_cast<std::uint32_t>(best)};
+                time += Tasks[best].wcet_us;
+                completed[best]++;
+                if (time > best_deadline)
+                {
+                    table.feasible = false;
+                }
+            }
+
+            // The last job must finish before the table repeats
+            if (time > HYPERPERIOD_US)
+            {
+                table.feasible = false;
+            }
+            return table;
+        }
+
+        static constexpr double computeUtilization()
+        {
+            double utilization = 0.0;
+            for (const StaticTask &task : Tasks)
+            {
+                utilization += static_cast<double>(task.wcet_us) / task.period_us;
+            }
+            return utilization;
+        }
+
+    public:
+        static constexpr Table TABLE = buildTable();
+        static constexpr double UTILIZATION = computeUtilization();
+
+        static_assert(UTILIZATION <= 1.0, "Task set needs more than 100% of the CPU");
+        static_assert(TABLE.feasible, "Task set is not schedulable by non-preemptive EDF over its hyperperiod");
+
+        // Walk the table for `hyperperiods` repetitions, or until stop() when 0.
+        // Runs on the calling thread.
+        void run(std::size_t hyperperiods = 0)
+        {
+            using Clock = std::chrono::steady_clock;
+            running_ = true;
+            auto frame_start = Clock::now();
+
+            for (std::size_t frame = 0; (hyperperiods == 0 || frame < hyperperiods) && running_; frame++)
+            {
+                for (const Entry &entry : TABLE.entries)
+                {
+                    const StaticTask &task = Tasks[entry.task];
+                    auto planned = frame_start + std::chrono::microseconds(entry.start_us);
+                    sleepUntil(planned);
+
+                    auto start = Clock::now();
+                    task.handler();
+                    auto end = Clock::now();
+
+                    TaskStatistics &statistics = statistics_[entry.task];
+                    auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+                    statistics.execution_count++;
+                    statistics.last_execution = start;
+                    statistics.total_execution_time += execution_time;
+                    statistics.average_execution_time = statistics.total_execution_time / statistics.execution_count;
+                    if (end > frame_start + std::chrono::microseconds(entry.deadline_us))
+                    {
+                        statistics.deadline_misses++;
+                    }
+
+                    auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(start - planned);
+                    if (lateness > max_lateness_)
+                    {
+                        max_lateness_ = lateness;
+                    }
+                }
+
+                frame_start += std::chrono::microseconds(HYPERPERIOD_US);
+            }
+
+            running_ = false;
+        }
+
+        // Ends run() after the current job
+        void stop() { running_ = false; }
+        bool isRunning() const { return running_; }
+
+        // Reuses the kernel's per-task statistics; only the fields that apply
+        // to a table-driven job are filled in
+        const TaskStatistics &getStatistics(std::size_t task) const { return statistics_[task]; }
+
+        // Worst observed delay of a job start behind its table slot
+        std::chrono::microseconds getMaxStartLateness() const { return max_lateness_; }
+
+        static constexpr const Table &getTable() { return TABLE; }
+        static constexpr std::chrono::microseconds getHyperperiod() { return std::chrono::microseconds(HYPERPERIOD_US); }
+
+    private:
+        std::array<TaskStatistics, TASK_COUNT> statistics_{};
+        std::chrono::microseconds max_lateness_{0};
+        std::atomic<bool> running_{false};
+    };
+
+} // namespace edurtos
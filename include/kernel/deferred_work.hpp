@@ -0,0 +1,112 @@
+#pragma once
+
+#include "scheduler.hpp"
+#include "latency_histogram.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace edurtos
+{
+    struct DeferredWorkStatistics
+    {
+        std::string name;
+        std::uint64_t raised = 0;
+        std::uint64_t runs = 0;      // Work function calls
+        std::uint64_t coalesced = 0; // Raises folded into an earlier pending run
+        LatencyHistogram latency;    // First raise of a run to its completion
+        std::chrono::nanoseconds max_run_time{0};
+    };
+
+    // Top-half/bottom-half split for interrupt handlers. The top half, an
+    // ISR, only calls raise(): a few atomic operations, lock-free and without
+    // allocation. A high priority kernel task, the bottom half, later runs the
+    // source's work function once for all raises since its last run (per
+    // source coalescing, as with Linux softirqs), so an interrupt storm costs
+    // one run per drain instead of one per interrupt.
+    //
+    // Pending sources form a bitmap, drained lowest source id first; the task
+    // handles up to `batch_size` sources per job and blocks on a notification
+    // when none are pending.
+    class DeferredWorkQueue
+    {
+    public:
+        static constexpr std::size_t MAX_SOURCES = 64;
+
+        // Receives the number of raises this run covers
+        using WorkFunction = std::function<void(std::uint32_t count)>;
+
+        explicit DeferredWorkQueue(std::string name = "deferred_work", std::uint8_t priority = 95,
+                                   std::size_t batch_size = 16);
+        ~DeferredWorkQueue() { stop(); }
+
+        DeferredWorkQueue(const DeferredWorkQueue &) = delete;
+        DeferredWorkQueue &operator=(const DeferredWorkQueue &) = delete;
+
+        // Returns the source id, or -1 when all sources are taken. Sources
+        // must be added before start().
+        int addSource(const std::string &name, WorkFunction work);
+
+        // Top half: callable from any thread, including interrupt handlers
+        bool raise(int source);
+
+        // Handler for VirtualGPIO::registerInterrupt() or a timer callback
+        // that raises `source`
+        std::function<void()> interruptHandler(int source)
+        {
+            return [this, source]()
+            { raise(source); };
+        }
+
+        // Add the bottom-half task to `scheduler` / remove it again. The
+        // scheduler finds tasks by name, so start() fails if it already has a
+        // task with this queue's name (e.g. another queue left at the
+        // default). stop() returns once a running drain has finished
+        // (Scheduler::removeTask() waits for it), so the queue may then be
+        // destroyed; do not call it from a work function.
+        bool start(Scheduler &scheduler);
+        void stop();
+
+        const TaskPtr &getTask() const { return task_; }
+        std::size_t getSourceCount() const { return source_count_; }
+
+        std::vector<DeferredWorkStatistics> getStatistics() const;
+        std::uint64_t getDrainCount() const { return drains_; }
+        std::size_t getMaxBatch() const { return max_batch_; }
+        void resetStatistics();
+
+    private:
+        struct Source
+        {
+            std::string name;
+            WorkFunction work;
+            std::atomic<std::uint32_t> count{0};         // Raises since the last run
+            std::atomic<std::int64_t> first_raise_ns{0}; // Of the raise that made count non-zero
+            std::atomic<std::uint64_t> raised{0};
+
+            // Owned by the drain task; read under statistics_mutex_
+            DeferredWorkStatistics statistics;
+        };
+
+        std::string name_;
+        std::size_t batch_size_;
+        std::array<Source, MAX_SOURCES> sources_;
+        std::size_t source_count_{0};
+        std::atomic<std::uint64_t> pending_{0}; // Bit per source with raises waiting
+
+        TaskPtr task_;
+        Scheduler *scheduler_{nullptr};
+
+        mutable std::mutex statistics_mutex_;
+        std::atomic<std::uint64_t> drains_{0};
+        std::atomic<std::size_t> max_batch_{0};
+
+        void drain(); // Task handler
+    };
+
+} // namespace edurtos
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "task.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace edurtos
+{
+    // Run queue ordered by absolute deadline (earliest deadline first), with
+    // the dynamic priority breaking ties. The key is fixed when a task is
+    // pushed: its next job's deadline, i.e. the deadline after its last
+    // release, or from now if it has not run yet. Tasks without a deadline
+    // sort after all others. Same interface and leaf lock parameter as
+    // BasicReadyQueue; membership is tracked in the task's queued_ hook.
+    template <typename Mutex = std::mutex>
+    class BasicEdfQueue
+    {
+    public:
+        template <typename OtherMutex>
+        using rebind = BasicEdfQueue<OtherMutex>;
+
+        BasicEdfQueue() { heap_.reserve(64); }
+
+        // Tasks can outlive the queue; leave their hooks unlinked
+        ~BasicEdfQueue() { clear(); }
+
+        BasicEdfQueue(const BasicEdfQueue &) = delete;
+        BasicEdfQueue &operator=(const BasicEdfQueue &) = delete;
+
+        // No-op if already queued
+        bool push(Task &task)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            std::chrono::steady_clock::time_point now{};
+            return insert(task, now);
+        }
+
+        std::size_t pushBatch(std::span<Task *const> tasks)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            std::chrono::steady_clock::time_point now{};
+            std::size_t pushed = 0;
+            for (Task *task : tasks)
+            {
+                pushed += insert(*task, now);
+            }
+            return pushed;
+        }
+
+        bool remove(Task &task)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            if (!task.queued_)
+            {
+                return false;
+            }
+
+            auto it = std::find_if(heap_.begin(), heap_.end(), [&](const Node &node)
+                                   { return node.task == &task; });
+            task.queued_ = false;
+            *it = heap_.back();
+            heap_.pop_back();
+            std::make_heap(heap_.begin(), heap_.end(), later);
+            return true;
+        }
+
+        Task *pop()
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            if (heap_.empty())
+            {
+                return nullptr;
+            }
+
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            Task *task = heap_.back().task;
+            heap_.pop_back();
+            task->queued_ = false;
+            return task;
+        }
+
+        bool empty() const
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return heap_.empty();
+        }
+
+        std::size_t size() const
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return heap_.size();
+        }
+
+        void clear()
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            for (const Node &node : heap_)
+            {
+                node.task->queued_ = false;
+            }
+            heap_.clear();
+        }
+
+    private:
+        struct Node
+        {
+            std::chrono::steady_clock::time_point deadline;
+            std::uint8_t priority;
+            std::uint64_t order; // FIFO among equal keys
+            Task *task;
+        };
+
+        // `now` is read on first use only, so tasks that have run already
+        // cost no clock read
+        bool insert(Task &task, std::chrono::steady_clock::time_point &now)
+        {
+            if (task.queued_)
+            {
+                return false;
+            }
+
+            auto deadline = std::chrono::steady_clock::time_point::max();
+            if (task.getDeadline().count() > 0)
+            {
+                auto last_release = task.getStatistics().last_execution;
+                if (last_release.time_since_epoch().count() > 0 && task.getPeriod().count() > 0)
+                {
+                    deadline = last_release + task.getEffectivePeriod() + task.getEffectiveDeadline();
+                }
+                else
+                {
+                    if (now.time_since_epoch().count() == 0)
+                    {
+                        now = std::chrono::steady_clock::now();
+                    }
+                    deadline = now + task.getEffectiveDeadline();
+                }
+            }
+
+            task.queued_ = true;
+            heap_.push_back(Node{deadline, task.getDynamicPriority(), next_order_++, &task});
+            std::push_heap(heap_.begin(), heap_.end(), later);
+            return true;
+        }
+
+        // Heap order: true if `a` runs after `b`
+        static bool later(const Node &a, const Node &b)
+        {
+            if (a.deadline != b.deadline)
+            {
+                return a.deadline > b.deadline;
+            }
+            if (a.priority != b.priority)
+            {
+                return a.priority < b.priority;
+            }
+            return a.order > b.order;
+        }
+
+        mutable Mutex mutex_;    // Leaf lock: never held while calling out
+        std::vector<Node> heap_; // Reserved up front; grows only past that
+        std::uint64_t next_order_{0};
+    };
+
+    using EdfQueue = BasicEdfQueue<>;
+
+} // namespace edurtos
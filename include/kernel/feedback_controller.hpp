@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace edurtos
+{
+    // Set points and gains for feedback-control scheduling
+    struct FeedbackConfig
+    {
+        float target_utilization = 90.0f; // Percent of CPU time spent running tasks
+        float target_miss_ratio = 0.01f;  // Fraction of jobs allowed to miss their deadline
+
+        // PI gains for the utilization loop (error measured as a fraction)
+        float utilization_kp = 0.2f;
+        float utilization_ki = 0.5f;
+
+        // PI gains for the miss-ratio loop
+        float miss_kp = 0.5f;
+        float miss_ki = 2.0f;
+
+        // Limits for the rate scale applied to periodic tasks (1.0 = nominal period)
+        float min_rate_scale = 0.25f;
+        float max_rate_scale = 1.0f;
+
+        std::chrono::milliseconds control_period{1000};
+    };
+
+    // One controller step, kept for instrumentation
+    struct FeedbackSample
+    {
+        std::chrono::steady_clock::time_point timestamp{};
+        float measured_utilization = 0.0f; // Percent
+        float measured_miss_ratio = 0.0f;
+        float utilization_output = 0.0f; // Rate change requested by the utilization loop
+        float miss_output = 0.0f;        // Rate change requested by the miss-ratio loop
+        float rate_scale = 1.0f;         // Actuator value after this step
+    };
+
+    // Incremental PI controller that tracks a utilization and a miss-ratio set point.
+    // Both loops propose a change of the task rate scale; the miss-ratio loop takes
+    // over whenever the measured miss ratio exceeds its set point.
+    class FeedbackController
+    {
+    public:
+        static constexpr std::size_t HISTORY_SIZE = 600;
+
+        explicit FeedbackController(FeedbackConfig config = FeedbackConfig{});
+
+        void setConfig(const FeedbackConfig &config);
+        FeedbackConfig getConfig() const;
+        void reset();
+
+        // Run one control step with the measurements of the last control period.
+        // Returns the new rate scale.
+        float update(float utilization, float miss_ratio);
+
+        float getRateScale() const;
+        FeedbackSample getLastSample() const;
+        std::vector<FeedbackSample> getHistory() const;
+
+    private:
+        mutable std::mutex mutex_;
+        FeedbackConfig config_;
+        float rate_scale_{1.0f};
+        float previous_utilization_error_{0.0f};
+        float previous_miss_error_{0.0f};
+        std::deque<FeedbackSample> history_;
+    };
+
+} // namespace edurtos
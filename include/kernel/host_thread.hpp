@@ -0,0 +1,18 @@
+#pragma once
+
+namespace edurtos
+{
+    // Restrict the calling thread to one host CPU, or allow all CPUs again
+    // with cpu < 0. Returns false if the platform refuses.
+    bool pinCurrentThread(int cpu);
+
+    // Move the calling thread into the host's real-time class, above every
+    // normal thread; higher `priority` wins among real-time threads, and each
+    // priority from 0 to REALTIME_PRIORITY_MAX gets its own host level.
+    // Returns false if the platform refuses or cannot keep the priorities
+    // apart: on Linux this needs CAP_SYS_NICE, on Windows the process must
+    // already run in REALTIME_PRIORITY_CLASS.
+    constexpr int REALTIME_PRIORITY_MAX = 13;
+    bool setCurrentThreadRealtime(int priority);
+
+} // namespace edurtos
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace edurtos
+{
+    // Log2 latency histogram with min/average/max. Bucket 0 counts latencies
+    // under 1 us, bucket i those in [2^(i-1), 2^i) us, and the last bucket
+    // everything longer. Not synchronized; owners guard it.
+    struct LatencyHistogram
+    {
+        static constexpr std::size_t BUCKETS = 24;
+
+        std::array<std::uint64_t, BUCKETS> buckets{};
+        std::uint64_t count = 0;
+        std::chrono::nanoseconds min{0};
+        std::chrono::nanoseconds max{0};
+        std::chrono::nanoseconds total{0};
+
+        void record(std::chrono::nanoseconds latency)
+        {
+            latency = std::max(latency, std::chrono::nanoseconds(0));
+            min = count == 0 ? latency : std::min(min, latency);
+            max = std::max(max, latency);
+            total += latency;
+            count++;
+
+            auto us = static_cast<std::uint64_t>(latency.count() / 1000);
+            buckets[std::min<std::size_t>(std::bit_width(us), BUCKETS - 1)]++;
+        }
+
+        std::chrono::nanoseconds average() const
+        {
+            return count > 0 ? total / static_cast<std::int64_t>(count) : std::chrono::nanoseconds(0);
+        }
+
+        // Upper edge of the bucket holding the given quantile (0-1), capped at max
+        std::chrono::nanoseconds percentile(double quantile) const
+        {
+            if (count == 0)
+            {
+                return std::chrono::nanoseconds(0);
+            }
+
+            auto target = static_cast<std::uint64_t>(std::clamp(quantile, 0.0, 1.0) * (count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t bucket = 0; bucket < BUCKETS; bucket++)
+            {
+                seen += buckets[bucket];
+                if (seen >= target)
+                {
+                    return bucket + 1 < BUCKETS ? std::min<std::chrono::nanoseconds>(std::chrono::microseconds(std::int64_t{1} << bucket), max)
+                                                : max;
+                }
+            }
+            return max;
+        }
+    };
+
+} // namespace edurtos
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "task.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace edurtos
+{
+    struct OffloadPoolStatistics
+    {
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0; // Returned normally
+        std::uint64_t failed = 0;    // Threw
+        std::uint64_t rejected = 0;  // Queue full at submit
+        std::uint64_t cancelled = 0; // Still queued at stop()
+        std::size_t queue_depth = 0; // Waiting for a worker
+        std::size_t max_queue_depth = 0;
+        std::size_t active = 0; // Running on a worker
+        std::chrono::microseconds average_queue_time{0};
+        std::chrono::microseconds max_queue_time{0};
+        std::chrono::microseconds average_run_time{0};
+        std::chrono::microseconds max_run_time{0};
+    };
+
+    template <typename R>
+    class OffloadResult;
+
+    // One submitted call, shared by the pool and the submitter's handle
+    class OffloadCall
+    {
+    public:
+        enum class Status
+        {
+            QUEUED,
+            RUNNING,
+            COMPLETED,
+            FAILED,
+            REJECTED,
+            CANCELLED
+        };
+
+        virtual ~OffloadCall() = default;
+
+        Status getStatus() const { return status_.load(std::memory_order_acquire); }
+        bool isDone() const { return getStatus() >= Status::COMPLETED; }
+        std::exception_ptr getError() const { return isDone() ? error_ : nullptr; }
+
+    protected:
+        virtual void invoke() = 0;
+
+    private:
+        friend class OffloadPool;
+        template <typename R>
+        friend class OffloadResult;
+
+        std::atomic<Status> status_{Status::QUEUED};
+
+        // Set once the pool is done with the call, after the completion
+        // wakeup if there was one; woke_waiter_ is written before it
+        std::atomic<bool> settled_{false};
+        bool woke_waiter_ = false;
+        std::exception_ptr error_;
+        std::weak_ptr<Task> waiter_;
+        std::chrono::steady_clock::time_point submit_time_;
+    };
+
+    // Handle to the result of a call submitted to an OffloadPool. The usual
+    // form inside a task handler, which keeps the handle across jobs:
+    //
+    //     if (!call.valid()) { call = pool.submit(readConfig); return; }
+    //     if (!call.wait()) return;   // Not done: BLOCKED until it is
+    //     use(call.get());
+    //     call = {};
+    template <typename R>
+    class OffloadResult
+    {
+    public:
+        using value_type = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+        OffloadResult() = default;
+
+        // Refers to a submitted call
+        bool valid() const { return state_ != nullptr; }
+
+        // Completed, failed, rejected or cancelled
+        bool ready() const { return state_ && state_->isDone(); }
+        bool succeeded() const { return state_ && state_->getStatus() == OffloadCall::Status::COMPLETED; }
+        OffloadCall::Status getStatus() const { return state_ ? state_->getStatus() : OffloadCall::Status::CANCELLED; }
+        std::exception_ptr getError() const { return state_ ? state_->getError() : nullptr; }
+
+        // From the submitting task's handler: true once the call is done.
+        // Otherwise arms the task's notification wait, so the task is
+        // BLOCKED after the current job until the call completes. Only the
+        // completion's own wakeup is consumed; while a notification from
+        // elsewhere (GPIO, timer) is pending the task stays ready instead.
+        bool wait()
+        {
+            if (!state_)
+            {
+                return true;
+            }
+
+            Task *task = Task::current();
+            if (state_->settled_.load(std::memory_order_acquire))
+            {
+                // Consume the completion's wakeup once, or the next submit
+                // would find it pending and not block
+                if (task && std::exchange(state_->woke_waiter_, false) && task->isNotificationPending())
+                {
+                    std::uint32_t value;
+                    task->waitForNotification(value, 0);
+                }
+                return true;
+            }
+
+            if (task)
+            {
+                task->armNotificationWait();
+            }
+            return false;
+        }
+
+        // Only after succeeded()
+        value_type &get() { return *state_->result; }
+
+    private:
+        friend class OffloadPool;
+
+        struct State : OffloadCall
+        {
+            std::function<R()> function;
+            std::optional<value_type> result;
+
+            void invoke() override
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    function();
+                    result.emplace();
+                }
+                else
+                {
+                    result.emplace(function());
+                }
+            }
+        };
+
+        std::shared_ptr<State> state_;
+    };
+
+    // Worker threads for blocking calls (file IO, sleeps, legacy drivers)
+    // that would otherwise hold the dispatcher thread for their duration.
+    // A task submits the call and ends its job; it is BLOCKED until a worker
+    // finishes the call and wakes it with a notification (NotifyAction::
+    // NO_ACTION, so the notification value is left alone), and its next job
+    // picks up the result. The dispatcher runs other tasks meanwhile.
+    //
+    // At most `max_concurrency` calls run at once; up to `max_queue_depth`
+    // more wait, and submissions beyond that are rejected at once.
+    class OffloadPool
+    {
+    public:
+        explicit OffloadPool(std::string name, std::size_t max_concurrency = 2, std::size_t max_queue_depth = 64);
+        ~OffloadPool();
+
+        OffloadPool(const OffloadPool &) = delete;
+        OffloadPool &operator=(const OffloadPool &) = delete;
+
+        // Called from a task handler, the task becomes the waiter: the wait is
+        // armed as by OffloadResult::wait(). From other threads nobody is woken
+        // and the result is polled.
+        template <typename F>
+        auto submit(F &&function) -> OffloadResult<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+            OffloadResult<R> handle;
+            auto state = std::make_shared<typename OffloadResult<R>::State>();
+            state->function = std::forward<F>(function);
+            handle.state_ = state;
+
+            if (enqueue(state))
+            {
+                handle.wait();
+            }
+            return handle;
+        }
+
+        // Workers start with the pool; stop() cancels queued calls, waits for
+        // running ones and wakes every waiter
+        void stop();
+        bool isRunning() const { return running_; }
+
+        const std::string &getName() const { return name_; }
+        std::size_t getMaxConcurrency() const { return max_concurrency_; }
+        std::size_t getMaxQueueDepth() const { return max_queue_depth_; }
+
+        OffloadPoolStatistics getStatistics() const;
+        void resetStatistics();
+
+    private:
+        std::string name_;
+        std::size_t max_concurrency_;
+        std::size_t max_queue_depth_;
+
+        std::vector<std::thread> workers_;
+        std::atomic<bool> running_{true};
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::deque<std::shared_ptr<OffloadCall>> queue_;
+        OffloadPoolStatistics statistics_;
+        std::chrono::microseconds total_queue_time_{0};
+        std::chrono::microseconds total_run_time_{0};
+
+        // False if rejected; the call is then already done
+        bool enqueue(const std::shared_ptr<OffloadCall> &call);
+        void workerLoop(std::size_t index);
+        void finish(OffloadCall &call, OffloadCall::Status status);
+    };
+
+} // namespace edurtos
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "scheduler.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edurtos
+{
+    // One row of the frame schedule table. An empty partition name is an
+    // idle window (spare time for the idle hook).
+    struct PartitionWindowConfig
+    {
+        std::string partition;
+        std::chrono::microseconds duration{0};
+    };
+
+    struct PartitionWindowStatistics
+    {
+        std::string partition;
+        std::chrono::microseconds offset{0}; // From the start of the major frame
+        std::chrono::microseconds duration{0};
+        std::uint64_t activations = 0;
+        std::uint64_t jobs = 0;
+        std::chrono::microseconds average_jitter{0}; // Actual minus planned window start
+        std::chrono::microseconds max_jitter{0};
+        std::chrono::microseconds busy_time{0}; // Spent in partition jobs
+        std::chrono::microseconds idle_time{0}; // Unused window time
+        std::uint64_t overruns = 0;             // Windows whose last job ended past the boundary
+        std::chrono::microseconds max_overrun{0};
+    };
+
+    // Cyclic, table-driven time partitioning in the style of ARINC 653.
+    //
+    // A major frame is a fixed sequence of windows. Each window belongs to a
+    // partition, a group of tasks with its own inner Scheduler that only runs
+    // inside that partition's windows. Windows start at fixed offsets from the
+    // frame start, so a late window never shifts the rest of the table. Jobs
+    // are not preempted, so the boundary is enforced at dispatch: a job only
+    // starts if its WCET estimate fits in what is left of the window. An
+    // overrun (a job longer than its estimate) is measured and the following
+    // window is shortened rather than moved.
+    class PartitionScheduler
+    {
+    public:
+        // Called with the end of unused window time; must return by then.
+        // Without a hook the partition waits for its tasks to become ready.
+        using IdleHook = std::function<void(const std::string &partition,
+                                            std::chrono::steady_clock::time_point until)>;
+
+        PartitionScheduler() = default;
+        ~PartitionScheduler();
+
+        PartitionScheduler(const PartitionScheduler &) = delete;
+        PartitionScheduler &operator=(const PartitionScheduler &) = delete;
+
+        // Partition and its inner scheduler; add the partition's tasks to it.
+        // Never call start() on it: it runs only inside its windows.
+        Scheduler &addPartition(const std::string &name);
+        Scheduler *getPartition(const std::string &name);
+
+        // Replaces the frame schedule; windows run back to back in table
+        // order. Fails if a window names an unknown partition or has no length.
+        bool configure(const std::vector<PartitionWindowConfig> &table);
+
+        void setIdleHook(IdleHook hook);
+
+        bool start();
+        void stop();
+        bool isRunning() const { return is_running_; }
+
+        std::chrono::microseconds getMajorFrame() const;
+        std::uint64_t getFrameCount() const { return frames_; }
+        std::vector<PartitionWindowStatistics> getStatistics() const;
+        void resetStatistics();
+
+    private:
+        struct Partition
+        {
+            std::string name;
+            std::unique_ptr<Scheduler> scheduler;
+        };
+
+        struct Window
+        {
+            Partition *partition = nullptr; // nullptr = idle window
+            std::chrono::microseconds offset{0};
+            std::chrono::microseconds duration{0};
+            PartitionWindowStatistics statistics;
+            std::int64_t total_jitter_us = 0;
+        };
+
+        void frameLoop();
+        void runWindow(Window &window, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+
+        std::vector<std::unique_ptr<Partition>> partitions_;
+        std::vector<Window> windows_;
+        std::chrono::microseconds major_frame_{0};
+        IdleHook idle_hook_;
+        mutable std::mutex mutex_; // Table, hook and statistics
+
+        std::thread frame_thread_;
+        std::atomic<bool> is_running_{false};
+        std::atomic<std::uint64_t> frames_{0};
+    };
+
+} // namespace edurtos
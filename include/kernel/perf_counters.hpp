@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace edurtos
+{
+    // Counter values for one job or accumulated over many jobs
+    struct PerfCounterValues
+    {
+        // Hardware events
+        std::uint64_t instructions = 0;
+        std::uint64_t cycles = 0;
+        std::uint64_t cache_misses = 0;
+        std::uint64_t branch_misses = 0;
+
+        // Software events, used when hardware counters are unavailable
+        std::uint64_t task_clock_ns = 0;
+        std::uint64_t context_switches = 0;
+        std::uint64_t page_faults = 0;
+
+        PerfCounterValues &operator+=(const PerfCounterValues &other);
+        PerfCounterValues operator-(const PerfCounterValues &other) const;
+    };
+
+    enum class PerfCounterMode
+    {
+        UNAVAILABLE, // No counters could be opened (or not a Linux host)
+        HARDWARE,    // Instructions, cycles, cache and branch misses
+        SOFTWARE     // Task clock, context switches and page faults
+    };
+
+    // A group of perf_event_open counters for the calling thread. The group is
+    // read with a single syscall, so dispatch boundaries only pay for one read.
+    class PerfCounterGroup
+    {
+    public:
+        PerfCounterGroup() = default;
+        ~PerfCounterGroup();
+
+        PerfCounterGroup(const PerfCounterGroup &) = delete;
+        PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+        // Must be called on the thread that should be measured
+        bool open();
+        void close();
+
+        bool isOpen() const { return leader_fd_ >= 0; }
+        PerfCounterMode getMode() const { return mode_; }
+
+        // Cumulative values since open()
+        PerfCounterValues read() const;
+
+    private:
+        int leader_fd_{-1};
+        std::vector<int> fds_;
+        std::vector<std::uint64_t PerfCounterValues::*> fields_;
+        PerfCounterMode mode_{PerfCounterMode::UNAVAILABLE};
+
+        bool openGroup(bool hardware);
+    };
+
+} // namespace edurtos
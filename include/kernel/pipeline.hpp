@@ -0,0 +1,344 @@
+#pragma once
+
+#include "scheduler.hpp"
+#include "bounded_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edurtos
+{
+    struct PipelineStageStatistics
+    {
+        std::string name;
+        std::uint64_t items = 0;   // Items processed
+        std::uint64_t dropped = 0; // Items the stage function filtered out
+        std::uint64_t stalls = 0;  // Jobs that ended because the output was full
+        double throughput = 0.0;   // Items per second since the pipeline started
+        std::size_t queue_depth = 0;
+        std::size_t queue_capacity = 0;
+        std::chrono::microseconds average_latency{0}; // Input queue entry to done
+        std::chrono::microseconds max_latency{0};
+    };
+
+    // Linear dataflow pipeline. Every stage is a task; consecutive stages are
+    // joined by bounded queues. A stage whose output queue is full ends its
+    // job and blocks until the next stage frees a slot, and a stage with an
+    // empty input blocks until an item arrives, so memory stays bounded under
+    // load spikes and no stage sleeps or polls.
+    //
+    // Stages may be added to different schedulers; pin those schedulers to
+    // different CPUs with Scheduler::setCpuAffinity() to run stages in parallel.
+    template <typename T>
+    class Pipeline
+    {
+    public:
+        // Transform the item in place; return false to drop it
+        using StageFunction = std::function<bool(T &)>;
+
+        explicit Pipeline(std::string name, std::size_t queue_capacity = 64, std::size_t batch_size = 16)
+            : name_(std::move(name)), queue_capacity_(queue_capacity), batch_size_(batch_size)
+        {
+            links_.push_back(std::make_unique<Link>(queue_capacity_)); // Pipeline input
+        }
+
+        ~Pipeline() { stop(); }
+
+        Pipeline(const Pipeline &) = delete;
+        Pipeline &operator=(const Pipeline &) = delete;
+
+        // Append a stage that reads the previous stage's output. The last
+        // stage added is the sink. Stages must be added before start().
+        Pipeline &addStage(const std::string &name, StageFunction function, Scheduler &scheduler,
+                           std::uint8_t priority = 50)
+        {
+            if (!stages_.empty())
+            {
+                links_.push_back(std::make_unique<Link>(queue_capacity_));
+            }
+
+            auto stage = std::make_unique<Stage>();
+            stage->name = name_ + "." + name;
+            stage->function = std::move(function);
+            stage->scheduler = &scheduler;
+            stage->input = links_.back().get();
+            stage->task = std::make_shared<Task>(stage->name, [this, s = stage.get()]()
+                                                 { runStage(*s); }, priority);
+            stage->input->consumer = stage->task;
+            if (!stages_.empty())
+            {
+                stages_.back()->output = stage->input;
+                stage->input->producer = stages_.back()->task;
+            }
+
+            stages_.push_back(std::move(stage));
+            return *this;
+        }
+
+        // Add the stage tasks to their schedulers
+        void start()
+        {
+            start_time_ = std::chrono::steady_clock::now();
+            for (auto &stage : stages_)
+            {
+                stage->scheduler->addTask(stage->task);
+            }
+        }
+
+        // Remove the stage tasks again. Scheduler::removeTask() waits for a
+        // running stage job, so the pipeline may be destroyed afterwards;
+        // do not call this from a stage function.
+        void stop()
+        {
+            for (auto &stage : stages_)
+            {
+                if (stage->scheduler->findTask(stage->name))
+                {
+                    stage->scheduler->removeTask(stage->name);
+                }
+            }
+        }
+
+        // Feed the first stage from any thread. Returns false while the input
+        // queue is full; that is the backpressure signal to the producer.
+        bool submit(const T &value)
+        {
+            Link &input = *links_.front();
+            if (!input.queue.tryPush(Item{value, now(), now()}))
+            {
+                input.rejected.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            input.wakeConsumer();
+            return true;
+        }
+
+        std::uint64_t getRejectedCount() const { return links_.front()->rejected; }
+
+        std::vector<PipelineStageStatistics> getStatistics() const
+        {
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+
+            std::vector<PipelineStageStatistics> statistics;
+            for (const auto &stage : stages_)
+            {
+                PipelineStageStatistics entry;
+                entry.name = stage->name;
+                entry.items = stage->items;
+                entry.dropped = stage->dropped;
+                entry.stalls = stage->stalls;
+                entry.throughput = elapsed > 0.0 ? entry.items / elapsed : 0.0;
+                entry.queue_depth = stage->input->queue.size();
+                entry.queue_capacity = stage->input->queue.capacity();
+                if (entry.items > 0)
+                {
+                    entry.average_latency = std::chrono::microseconds(stage->total_latency_ns / entry.items / 1000);
+                }
+                entry.max_latency = std::chrono::microseconds(stage->max_latency_ns / 1000);
+                statistics.push_back(std::move(entry));
+            }
+            return statistics;
+        }
+
+        // Input queue entry of the first stage to completion of the sink
+        std::chrono::microseconds getAverageEndToEndLatency() const
+        {
+            auto items = sink_items_.load();
+            return std::chrono::microseconds(items > 0 ? end_to_end_ns_ / items / 1000 : 0);
+        }
+
+    private:
+        struct Item
+        {
+            T value;
+            std::uint64_t created_ns;  // Entered the pipeline
+            std::uint64_t enqueued_ns; // Entered the current stage's queue
+        };
+
+        // Queue between two stages plus the wait flags of both ends
+        struct Link
+        {
+            explicit Link(std::size_t capacity) : queue(capacity) {}
+
+            BoundedQueue<Item> queue;
+            std::weak_ptr<Task> producer; // Empty for the pipeline input
+            std::weak_ptr<Task> consumer;
+            std::atomic<bool> producer_waiting{false};
+            std::atomic<bool> consumer_waiting{false};
+            std::atomic<std::uint64_t> rejected{0};
+
+            bool full() const { return queue.size() >= queue.capacity(); }
+
+            void wakeConsumer() { wake(consumer_waiting, consumer); }
+
+            // Only once half the queue is free, so a blocked producer resumes
+            // with a batch of room instead of one slot per wakeup
+            void wakeProducer()
+            {
+                if (queue.size() <= queue.capacity() / 2)
+                {
+                    wake(producer_waiting, producer);
+                }
+            }
+
+            static void wake(std::atomic<bool> &waiting, const std::weak_ptr<Task> &task)
+            {
+                if (waiting.load() && waiting.exchange(false))
+                {
+                    if (auto target = task.lock())
+                    {
+                        target->notify(0, NotifyAction::NO_ACTION);
+                    }
+                }
+            }
+
+            // Publish the wait, then re-check the condition it waits on. A
+            // notification racing in leaves the task READY to try again. Only
+            // the pending flag is consumed, not the task's notification value.
+            template <typename Condition>
+            static bool armWait(std::atomic<bool> &waiting, Condition ready)
+            {
+                waiting.store(true);
+                if (ready())
+                {
+                    waiting.store(false);
+                    return false;
+                }
+                if (Task *self = Task::current())
+                {
+                    std::uint32_t value;
+                    self->waitForNotification(value, 0);
+                }
+                return true;
+            }
+        };
+
+        struct Stage
+        {
+            std::string name;
+            StageFunction function;
+            Scheduler *scheduler = nullptr;
+            TaskPtr task;
+            Link *input = nullptr;
+            Link *output = nullptr; // nullptr for the sink
+            std::optional<Item> pending; // Processed, waiting for room in output
+
+            std::atomic<std::uint64_t> items{0};
+            std::atomic<std::uint64_t> dropped{0};
+            std::atomic<std::uint64_t> stalls{0};
+            std::atomic<std::uint64_t> total_latency_ns{0};
+            std::atomic<std::uint64_t> max_latency_ns{0};
+        };
+
+        static std::uint64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // Push the held item. False when the stage has to wait for room.
+        // A push can fail even though full() saw room: the consumer's pop
+        // lowers size() before it releases the slot.
+        static bool pushPending(Stage &stage)
+        {
+            while (stage.pending)
+            {
+                if (stage.output->queue.tryPush(*stage.pending))
+                {
+                    stage.pending.reset();
+                    stage.output->wakeConsumer();
+                    return true;
+                }
+                if (Link::armWait(stage.output->producer_waiting, [&]
+                                  { return !stage.output->full(); }))
+                {
+                    stage.stalls.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                std::this_thread::yield(); // Slot release in progress
+            }
+            return true;
+        }
+
+        // One job: move up to batch_size items, then let other tasks run
+        void runStage(Stage &stage)
+        {
+            if (stage.output && !pushPending(stage))
+            {
+                return;
+            }
+
+            for (std::size_t n = 0; n < batch_size_; n++)
+            {
+                // Check for room before taking an item, so items wait in the
+                // queue rather than in the stage; only this stage pushes to
+                // its output
+                if (stage.output && stage.output->full())
+                {
+                    if (Link::armWait(stage.output->producer_waiting, [&]
+                                      { return !stage.output->full(); }))
+                    {
+                        stage.stalls.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+
+                Item item;
+                if (!stage.input->queue.tryPop(item))
+                {
+                    Link::armWait(stage.input->consumer_waiting, [&]
+                                  { return !stage.input->queue.empty(); });
+                    return;
+                }
+                stage.input->wakeProducer();
+
+                bool keep = stage.function(item.value);
+
+                std::uint64_t done = now();
+                std::uint64_t latency = done - item.enqueued_ns;
+                stage.items.fetch_add(1, std::memory_order_relaxed);
+                stage.total_latency_ns.fetch_add(latency, std::memory_order_relaxed);
+                if (latency > stage.max_latency_ns.load(std::memory_order_relaxed))
+                {
+                    stage.max_latency_ns.store(latency, std::memory_order_relaxed);
+                }
+
+                if (!keep)
+                {
+                    stage.dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (stage.output)
+                {
+                    item.enqueued_ns = done;
+                    stage.pending = std::move(item);
+                    if (!pushPending(stage))
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    sink_items_.fetch_add(1, std::memory_order_relaxed);
+                    end_to_end_ns_.fetch_add(done - item.created_ns, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::string name_;
+        std::size_t queue_capacity_;
+        std::size_t batch_size_;
+        std::vector<std::unique_ptr<Link>> links_;
+        std::vector<std::unique_ptr<Stage>> stages_;
+        std::chrono::steady_clock::time_point start_time_{};
+        std::atomic<std::uint64_t> sink_items_{0};
+        std::atomic<std::uint64_t> end_to_end_ns_{0};
+    };
+
+} // namespace edurtos
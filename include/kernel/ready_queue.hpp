@@ -0,0 +1,207 @@
+#pragma once
+
+#include "task.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+namespace edurtos
+{
+    // Run queue with one FIFO list per priority level and a bitmap of
+    // non-empty levels. Push, remove and pop are O(1), so suspend and resume
+    // can update the queue directly instead of waiting for a rebuild.
+    //
+    // Lists are linked through hooks inside the tasks, so queue operations
+    // neither allocate nor touch shared_ptr reference counts. The queue only
+    // borrows tasks: whoever owns a task must remove it before releasing it.
+    //
+    // Mutex is the leaf lock around every operation. The scheduler picks it
+    // from its Lock policy (NullMutex under NoLock), so a single-threaded
+    // scheduler inlines the whole dispatch decision without locking.
+    template <typename Mutex = std::mutex>
+    class BasicReadyQueue
+    {
+    public:
+        static constexpr std::size_t PRIORITY_LEVELS = 100; // Priorities 0-99
+
+        // The same queue with another leaf lock
+        template <typename OtherMutex>
+        using rebind = BasicReadyQueue<OtherMutex>;
+
+        BasicReadyQueue() = default;
+
+        // Tasks can outlive the queue; leave their hooks unlinked
+        ~BasicReadyQueue() { clear(); }
+
+        BasicReadyQueue(const BasicReadyQueue &) = delete;
+        BasicReadyQueue &operator=(const BasicReadyQueue &) = delete;
+
+        // Queued at the task's current dynamic priority; no-op if already queued
+        bool push(Task &task)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return link(task);
+        }
+
+        // Pushes a whole batch under one lock acquisition; returns how many
+        // were not queued already
+        std::size_t pushBatch(std::span<Task *const> tasks)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            std::size_t pushed = 0;
+            for (Task *task : tasks)
+            {
+                pushed += link(*task);
+            }
+            return pushed;
+        }
+
+        // No-op if the task is not queued
+        bool remove(Task &task)
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            if (!task.queued_)
+            {
+                return false;
+            }
+
+            unlink(task);
+            return true;
+        }
+
+        // Highest priority first, FIFO within a level; nullptr when empty
+        Task *pop()
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            int priority = highestLevel();
+            if (priority < 0)
+            {
+                return nullptr;
+            }
+
+            Task *task = levels_[priority].head;
+            unlink(*task);
+            return task;
+        }
+
+        bool empty() const
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return size_ == 0;
+        }
+
+        std::size_t size() const
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return size_;
+        }
+
+        void clear()
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            for (auto &level : levels_)
+            {
+                while (level.head)
+                {
+                    unlink(*level.head);
+                }
+            }
+        }
+
+    private:
+        struct Level
+        {
+            Task *head = nullptr;
+            Task *tail = nullptr;
+        };
+
+        mutable Mutex mutex_; // Leaf lock: never held while calling out
+        std::array<Level, PRIORITY_LEVELS> levels_{};
+        std::array<std::uint64_t, 2> bitmap_{}; // Bit set for each non-empty level
+        std::size_t size_{0};
+
+        bool link(Task &task)
+        {
+            if (task.queued_)
+            {
+                return false;
+            }
+
+            auto priority = std::min<std::uint8_t>(task.getDynamicPriority(), PRIORITY_LEVELS - 1);
+            Level &level = levels_[priority];
+
+            task.queue_priority_ = priority;
+            task.queue_prev_ = level.tail;
+            task.queue_next_ = nullptr;
+            task.queued_ = true;
+
+            if (level.tail)
+            {
+                level.tail->queue_next_ = &task;
+            }
+            else
+            {
+                level.head = &task;
+                setBit(priority);
+            }
+            level.tail = &task;
+            size_++;
+            return true;
+        }
+
+        void unlink(Task &task)
+        {
+            Level &level = levels_[task.queue_priority_];
+
+            if (task.queue_prev_)
+            {
+                task.queue_prev_->queue_next_ = task.queue_next_;
+            }
+            else
+            {
+                level.head = task.queue_next_;
+            }
+
+            if (task.queue_next_)
+            {
+                task.queue_next_->queue_prev_ = task.queue_prev_;
+            }
+            else
+            {
+                level.tail = task.queue_prev_;
+            }
+
+            if (!level.head)
+            {
+                clearBit(task.queue_priority_);
+            }
+
+            task.queue_prev_ = nullptr;
+            task.queue_next_ = nullptr;
+            task.queued_ = false;
+            size_--;
+        }
+
+        void setBit(std::uint8_t priority) { bitmap_[priority / 64] |= std::uint64_t{1} << (priority % 64); }
+        void clearBit(std::uint8_t priority) { bitmap_[priority / 64] &= ~(std::uint64_t{1} << (priority % 64)); }
+
+        int highestLevel() const
+        {
+            // Highest set bit: one count-leading-zeros per word
+            for (int word = static_cast<int>(bitmap_.size()) - 1; word >= 0; word--)
+            {
+                if (bitmap_[word] != 0)
+                {
+                    return word * 64 + 63 - std::countl_zero(bitmap_[word]);
+                }
+            }
+            return -1;
+        }
+    };
+
+    using ReadyQueue = BasicReadyQueue<>;
+
+} // namespace edurtos
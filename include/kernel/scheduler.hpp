@@ -1,78 +1,148 @@
 #pragma once
 
 #include "task.hpp"
+#include "feedback_controller.hpp"
+#include "perf_counters.hpp"
+#include "scheduler_snapshot.hpp"
+#include "task_event_bus.hpp"
+#include "ready_queue.hpp"
+#include "edf_queue.hpp"
+#include "scheduler_policies.hpp"
+#include "wake_source.hpp"
 #include <vector>
-#include <queue>
 #include <map>
+#include <type_traits>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <memory>
 
 namespace edurtos
 {
-    class Scheduler
+    // Scheduler parameterized at compile time:
+    //   Queue      - run-queue structure and selection order (ReadyQueue for
+    //                fixed priorities, EdfQueue for earliest deadline first)
+    //   Preemption - when a dispatch slot ends early (RuntimePreemption follows
+    //                setPreemptionMode(); FixedPreemption<> folds to constants)
+    //   Lock       - scheduler state and ready queue locking (MutexLock, or
+    //                NoLock for a scheduler driven only through runUntil())
+    // Member definitions live in scheduler.cpp, which explicitly instantiates
+    // the supported combinations; `Scheduler` is the default configuration.
+    template <typename Queue = ReadyQueue, typename Preemption = RuntimePreemption, typename Lock = MutexLock>
+    class BasicScheduler : public TaskStateListener<>, public WakeSourceHost
     {
     public:
-        struct TaskPriorityCompare
-        {
-            bool operator()(const TaskPtr &a, const TaskPtr &b) const
-            {
-                return a->getDynamicPriority() < b->getDynamicPriority();
-            }
-        };
-
-        enum class PreemptionMode
-        {
-            NONE,       // No preemption (fully cooperative)
-            TIME_SLICE, // Preemption based on time slices
-            PRIORITY,   // Preemption based on priority
-            HYBRID      // Both time slice and priority based preemption
-        };
+        using PreemptionMode = edurtos::PreemptionMode;
+        using mutex_type = typename Lock::mutex_type;
+        using queue_type = typename Queue::template rebind<typename Lock::queue_mutex_type>;
 
     private:
         std::vector<TaskPtr> all_tasks_;
-        std::priority_queue<TaskPtr, std::vector<TaskPtr>, TaskPriorityCompare> ready_queue_;
-        TaskPtr current_task_;
+        queue_type ready_queue_;
+        std::atomic<Task *> current_task_{nullptr}; // Borrowed; owned through all_tasks_
         std::atomic<bool> is_running_{false};
         std::thread scheduler_thread_;
         std::thread deadline_monitor_thread_;
-        std::mutex scheduler_mutex_;
-        std::condition_variable scheduler_cv_;
+        mutable mutex_type scheduler_mutex_;
+        typename Lock::condition_type scheduler_cv_;
+
+        // The job in progress, if any. A task removed while its job runs is
+        // kept alive in retired_tasks_ until the job has returned.
+        Task *running_job_{nullptr};
+        std::thread::id job_thread_;
+        std::vector<TaskPtr> retired_tasks_;
+        typename Lock::condition_type job_done_cv_;
         std::chrono::milliseconds time_slice_{50}; // Default time slice of 50ms
         std::chrono::steady_clock::time_point last_schedule_time_;
         PreemptionMode preemption_mode_{PreemptionMode::HYBRID};
         std::atomic<bool> force_reschedule_{false};
+        std::atomic<bool> wakeup_pending_{false}; // A task became ready outside the loop
+        std::atomic<int> cpu_affinity_{-1};       // Host CPU of the dispatcher thread, -1 = any
+        std::atomic<bool> affinity_changed_{false};
 
         // For visualization
         std::map<TaskPtr, char> task_symbols_;
-        std::atomic<float> cpu_utilization_{0.0f};
+        std::atomic<float> cpu_utilization_{0.0f}; // Thread CPU time of task jobs
+        std::atomic<float> occupancy_{0.0f};       // Wall-clock time spent inside jobs
         std::chrono::steady_clock::time_point idle_start_time_;
         std::chrono::microseconds total_run_time_{0};
         std::chrono::microseconds total_idle_time_{0};
+        std::chrono::microseconds total_cpu_time_{0};
+        bool is_idle_{false};
+
+        // Feedback-control scheduling
+        FeedbackController feedback_controller_;
+        std::atomic<bool> feedback_enabled_{false};
+        std::chrono::steady_clock::time_point last_control_time_;
+        std::chrono::microseconds control_run_time_{0};
+        std::chrono::microseconds control_idle_time_{0};
+        std::size_t control_jobs_{0};
+        std::size_t control_misses_{0};
+
+        // Periodic tasks grouped by period. While periods are enforced (feedback
+        // mode) a group is released by one timer event instead of per-task
+        // checks, and all groups due at the same instant (harmonic periods
+        // share instants, as they have a common phase) are pushed to the
+        // ready queue as one batch.
+        struct ReleaseGroup
+        {
+            std::chrono::milliseconds period; // Nominal period of every member
+            std::chrono::steady_clock::time_point last_release;
+            std::chrono::steady_clock::time_point next_release;
+            std::vector<Task *> members; // Borrowed; owned through all_tasks_
+        };
+        std::vector<ReleaseGroup> release_groups_; // Sorted by period, never empty groups
+        std::vector<Task *> release_batch_;        // Reused for every batch push
+        std::vector<Task *> skipped_batch_;        // Jobs too long for a runUntil() budget
+        std::chrono::steady_clock::time_point release_epoch_;
+        std::chrono::steady_clock::time_point next_group_release_{std::chrono::steady_clock::time_point::max()};
+
+        // Per-task performance counters, owned by the scheduler thread
+        PerfCounterGroup perf_counters_;
+        std::atomic<bool> perf_enabled_{false};
+        std::atomic<PerfCounterMode> perf_mode_{PerfCounterMode::UNAVAILABLE};
+        std::atomic<std::uint64_t> perf_overhead_ns_{0};
+        std::atomic<std::uint64_t> perf_reads_{0};
+
+        // State transitions of all tasks in this scheduler
+        TaskEventBus event_bus_;
+
+        // Deferred wakeups (e.g. topic subscribers), run on the scheduler thread
+        std::mutex wake_sources_mutex_;
+        std::vector<WakeSource *> wake_sources_;
+        std::atomic<bool> wake_sources_pending_{false};
+
+        // Shared monitoring snapshot, rebuilt at most once per interval
+        std::atomic<std::shared_ptr<const SchedulerSnapshot>> snapshot_;
+        std::atomic<bool> snapshot_building_{false};
+        std::atomic<std::chrono::milliseconds::rep> snapshot_interval_ms_{50};
+        std::uint64_t snapshot_sequence_{0};
 
         // For recovery
         std::atomic<size_t> recovery_attempts_{0};
         static constexpr size_t MAX_RECOVERY_ATTEMPTS = 3;
 
     public:
-        Scheduler(std::chrono::milliseconds time_slice = std::chrono::milliseconds(50));
-        ~Scheduler();
+        BasicScheduler(std::chrono::milliseconds time_slice = std::chrono::milliseconds(50));
+        ~BasicScheduler();
 
-        // Task management
+        // Task management. removeTask() returns once a running job of the
+        // task has finished, unless called from that job itself.
         void addTask(TaskPtr task);
         void removeTask(const std::string &name);
         TaskPtr findTask(const std::string &name);
 
         // Get the currently running task
-        TaskPtr getCurrentTask() const { return current_task_; }
+        TaskPtr getCurrentTask() const;
 
         // Get all tasks
         const std::vector<TaskPtr> &getAllTasks() const { return all_tasks_; }
 
-        // Scheduler control
-        void start();
+        // Scheduler control. A NoLock scheduler has no threads of its own.
+        void start()
+            requires(!std::is_same_v<Lock, NoLock>);
         void stop();
         void yield(); // Cooperative yield
         void setPreemptionMode(PreemptionMode mode);
@@ -80,30 +150,101 @@ namespace edurtos
         void setTimeSlice(std::chrono::milliseconds time_slice);
         std::chrono::milliseconds getTimeSlice() const { return time_slice_; }
 
+        // Pin the dispatcher thread to one host CPU (-1 for any). Several
+        // schedulers pinned to different CPUs run their tasks in parallel.
+        void setCpuAffinity(int cpu);
+        int getCpuAffinity() const { return cpu_affinity_; }
+
+        // Drive the scheduler from the calling thread instead of start(), e.g.
+        // inside a partition window. Runs ready jobs until `budget_end`, only
+        // starting a job whose WCET estimate fits in the remaining time, and
+        // returns early when nothing fits. Returns the number of jobs run.
+        std::size_t runUntil(std::chrono::steady_clock::time_point budget_end);
+
+        // Block until a task becomes ready or `until`; false on timeout
+        bool waitForWakeup(std::chrono::steady_clock::time_point until);
+
         // Adaptive priority
         void adjustPriorities();
 
+        // Feedback-control scheduling: a PI controller replaces the open-loop
+        // priority adjustment and scales the release rate of periodic tasks
+        void enableFeedbackControl(bool enable);
+        bool isFeedbackControlEnabled() const { return feedback_enabled_; }
+        FeedbackController &getFeedbackController() { return feedback_controller_; }
+
         // Performance metrics
         float getCpuUtilization() const { return cpu_utilization_; }
+        float getOccupancy() const { return occupancy_; }
         void updateCpuUtilization();
 
+        // Hardware performance counters read at dispatch boundaries (switchable at runtime)
+        void enablePerfCounters(bool enable) { perf_enabled_ = enable; }
+        bool arePerfCountersEnabled() const { return perf_enabled_; }
+        PerfCounterMode getPerfCounterMode() const { return perf_mode_; }
+        std::chrono::nanoseconds getPerfCounterOverhead() const { return std::chrono::nanoseconds(perf_overhead_ns_.load()); }
+        std::uint64_t getPerfCounterReads() const { return perf_reads_; }
+
+        // Admission control from probabilistic WCET estimates (percent of one CPU)
+        float estimateUtilization(double exceedance_probability = 1e-6);
+        bool canAdmit(std::chrono::microseconds wcet,
+                      std::chrono::milliseconds period,
+                      double exceedance_probability = 1e-6,
+                      float utilization_bound = 100.0f);
+
+        // Monitoring snapshot shared by all consumers. Rebuilt on demand when
+        // older than the snapshot interval, so the cost per interval is one
+        // pass over the tasks however many consumers poll.
+        std::shared_ptr<const SchedulerSnapshot> snapshot();
+        void setSnapshotInterval(std::chrono::milliseconds interval) { snapshot_interval_ms_ = interval.count(); }
+        std::chrono::milliseconds getSnapshotInterval() const { return std::chrono::milliseconds(snapshot_interval_ms_.load()); }
+
+        // Every state transition of this scheduler's tasks, pushed to subscribers
+        TaskEventBus &getEventBus() { return event_bus_; }
+
+        // Sources of deferred wakeups. A source must be removed (or detach
+        // itself) before it is destroyed; the scheduler detaches any left.
+        void addWakeSource(WakeSource &source);
+        void removeWakeSource(WakeSource &source) override;
+        void signalWakeSources() override; // Called by WakeSource::requestWakeup()
+
         // Visualization
         void printTaskStates();
         std::string getTaskStateVisualization();
 
         // Recovery
-        bool attemptTaskRecovery(TaskPtr task);
+        bool attemptTaskRecovery(Task &task);
+
+        // Applies suspend/resume/terminate to the ready queue immediately
+        void onTaskStateChange(Task &task, TaskState from, TaskState to) override;
 
     private:
         void schedulerLoop();
         void deadlineMonitorLoop();
-        TaskPtr selectNextTask();
+        void runJob(Task &task, std::unique_lock<mutex_type> &lock);
+        bool isRetired(const Task &task) const;
+        void releaseRetiredTasks();
+        Task *selectNextTask(std::chrono::microseconds budget = std::chrono::microseconds::max());
         void updateTaskStatistics();
         void checkDeadlines();
-        bool shouldPreempt(TaskPtr new_task) const;
+        void runFeedbackControl();
+        void resetControlWindow();
+        bool isReleased(const Task &task, std::chrono::steady_clock::time_point now) const;
+        void addToReleaseGroup(Task &task);
+        void removeFromReleaseGroup(Task &task);
+        const ReleaseGroup *findReleaseGroup(std::chrono::milliseconds period) const;
+        void restartReleaseGroups(std::chrono::steady_clock::time_point now);
+        void releaseDueGroups(std::chrono::steady_clock::time_point now);
+        bool shouldPreempt(const Task &new_task) const;
         char getSymbolForTaskState(TaskState state);
+        bool updatePerfCounterState();
+        PerfCounterValues readPerfCounters();
         void enterIdleState();
         void exitIdleState();
+        void processWakeSources();
+        std::shared_ptr<const SchedulerSnapshot> buildSnapshot();
     };
 
+    using Scheduler = BasicScheduler<>;
+
 } // namespace edurtos
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+namespace edurtos
+{
+    enum class PreemptionMode
+    {
+        NONE,       // No preemption (fully cooperative)
+        TIME_SLICE, // Preemption based on time slices
+        PRIORITY,   // Preemption based on priority
+        HYBRID      // Both time slice and priority based preemption
+    };
+
+    // Preemption policies. Jobs run to completion, so "preemption" means
+    // ending the current dispatch slot early at the next boundary.
+
+    // Follows Scheduler::setPreemptionMode() at run time
+    struct RuntimePreemption
+    {
+        static bool timeSlicing(PreemptionMode mode)
+        {
+            return mode == PreemptionMode::TIME_SLICE || mode == PreemptionMode::HYBRID;
+        }
+
+        static bool priorityPreemption(PreemptionMode mode)
+        {
+            return mode == PreemptionMode::PRIORITY || mode == PreemptionMode::HYBRID;
+        }
+    };
+
+    // Fixed at compile time; the run-time mode is ignored and the checks fold away
+    template <PreemptionMode Mode>
+    struct FixedPreemption
+    {
+        static constexpr bool timeSlicing(PreemptionMode)
+        {
+            return Mode == PreemptionMode::TIME_SLICE || Mode == PreemptionMode::HYBRID;
+        }
+
+        static constexpr bool priorityPreemption(PreemptionMode)
+        {
+            return Mode == PreemptionMode::PRIORITY || Mode == PreemptionMode::HYBRID;
+        }
+    };
+
+    using NoPreemption = FixedPreemption<PreemptionMode::NONE>;
+    using PriorityPreemption = FixedPreemption<PreemptionMode::PRIORITY>;
+
+    // Lock policies for the scheduler's own state and the ready queue's leaf
+    // lock (queue_mutex_type).
+
+    struct MutexLock
+    {
+        using mutex_type = std::mutex;
+        using condition_type = std::condition_variable;
+        using queue_mutex_type = std::mutex;
+    };
+
+    // Satisfies Lockable without locking anything
+    struct NullMutex
+    {
+        void lock() {}
+        void unlock() {}
+        bool try_lock() { return true; }
+    };
+
+    // For a scheduler driven from a single thread with runUntil(). Nothing is
+    // locked, including the ready queue, so tasks may only be suspended,
+    // resumed or notified from that thread; start() does not compile.
+    struct NoLock
+    {
+        using mutex_type = NullMutex;
+        using condition_type = std::condition_variable_any;
+        using queue_mutex_type = NullMutex;
+    };
+
+} // namespace edurtos
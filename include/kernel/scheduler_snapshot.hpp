@@ -0,0 +1,63 @@
+#pragma once
+
+#include "task.hpp"
+#include "feedback_controller.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edurtos
+{
+    // Copy of one task's monitoring data at snapshot time
+    struct TaskSnapshot
+    {
+        const Task *task = nullptr; // Identity only; never dereferenced by consumers
+        std::uint32_t id = 0;
+        std::string name;
+        char symbol = '?';
+        TaskState state = TaskState::READY;
+        std::uint8_t base_priority = 0;
+        std::uint8_t dynamic_priority = 0;
+        std::chrono::milliseconds period{0};
+        std::chrono::milliseconds deadline{0};
+        float rate_scale = 1.0f;
+        float deadline_percent = 0.0f; // Deadline counter relative to the deadline
+        TaskStatistics statistics{};
+
+        static TaskSnapshot capture(const Task &task, char symbol = '?');
+    };
+
+    // Immutable view of the scheduler shared by all monitoring consumers. Once
+    // published it is never modified, so readers need no locks.
+    struct SchedulerSnapshot
+    {
+        std::uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point timestamp{};
+
+        std::vector<TaskSnapshot> tasks;
+        int current_task = -1; // Index into tasks, -1 when idle
+
+        float cpu_utilization = 0.0f;
+        float occupancy = 0.0f;
+        std::chrono::microseconds total_run_time{0};
+        std::chrono::microseconds total_idle_time{0};
+        std::chrono::microseconds total_cpu_time{0};
+        std::size_t recovery_attempts = 0;
+
+        bool feedback_enabled = false;
+        FeedbackSample feedback{};
+
+        const TaskSnapshot *getCurrentTask() const
+        {
+            return current_task >= 0 ? &tasks[current_task] : nullptr;
+        }
+
+        const TaskSnapshot *findTask(const Task *task) const;
+        const TaskSnapshot *findTask(const std::string &name) const;
+        const TaskSnapshot *findTask(std::uint32_t id) const;
+    };
+
+    const char *taskStateName(TaskState state);
+
+} // namespace edurtos
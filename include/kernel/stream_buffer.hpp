@@ -0,0 +1,118 @@
+#pragma once
+
+#include "task.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace edurtos
+{
+    // Lock-free single-producer/single-consumer byte stream. Storage is
+    // allocated once; sends and receives never block or allocate, so the
+    // producer side may run in a virtual interrupt handler.
+    //
+    // A reader task can wait for data: once `trigger_level` bytes are queued
+    // the producer notifies it, so it is woken once per batch rather than
+    // once per byte.
+    class StreamBuffer
+    {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit StreamBuffer(std::size_t capacity, std::size_t trigger_level = 1);
+
+        StreamBuffer(const StreamBuffer &) = delete;
+        StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+        // Producer side. Copies as much as fits and returns the byte count;
+        // a short count is the flow-control signal.
+        std::size_t send(const void *data, std::size_t length);
+
+        // Zero-copy producer side: fill (part of) the returned region, then
+        // commit the bytes written. The region may be shorter than the free
+        // space when it wraps.
+        std::span<std::byte> writeRegion();
+        void commit(std::size_t length);
+
+        // Consumer side. Returns the number of bytes copied out.
+        std::size_t receive(void *data, std::size_t max_length);
+
+        // Zero-copy consumer side: read the returned region, then consume
+        std::span<const std::byte> readRegion() const;
+        void consume(std::size_t length);
+
+        // Called by the reader task's handler. Returns true if at least the
+        // trigger level is queued; otherwise arms a wait so the task blocks
+        // when its job returns and is notified once the level is reached.
+        // The wakeup leaves the task's notification value alone, so the task
+        // may also count GPIO or timer notifications (INCREMENT) in it.
+        bool waitForData();
+
+        // Task notified when the trigger level is reached; set before use
+        void setReader(const TaskPtr &task) { reader_ = task; }
+        void setTriggerLevel(std::size_t level);
+        std::size_t getTriggerLevel() const { return trigger_level_; }
+
+        std::size_t bytesAvailable() const;
+        std::size_t spacesAvailable() const { return capacity_ - bytesAvailable(); }
+        bool empty() const { return bytesAvailable() == 0; }
+        bool full() const { return spacesAvailable() == 0; }
+        std::size_t capacity() const { return capacity_; }
+
+        // Only when neither side is active
+        void reset();
+
+    private:
+        friend class MessageBuffer;
+
+        void copyIn(std::size_t position, const void *data, std::size_t length);
+        void copyOut(std::size_t position, void *data, std::size_t length) const;
+        void wakeReader(std::size_t available);
+
+        std::size_t capacity_;
+        std::size_t mask_;
+        std::unique_ptr<std::byte[]> storage_;
+        std::atomic<std::size_t> trigger_level_;
+
+        std::weak_ptr<Task> reader_;
+        std::atomic<bool> reader_waiting_{false};
+
+        // Free-running positions on separate cache lines; each side writes one
+        alignas(64) std::atomic<std::size_t> write_position_{0};
+        alignas(64) std::atomic<std::size_t> read_position_{0};
+    };
+
+    // Length-prefixed messages on top of a stream buffer. A message is
+    // delivered whole or not at all, and the reader is woken per message.
+    class MessageBuffer
+    {
+    public:
+        using LengthType = std::uint32_t;
+
+        // `capacity` includes the length prefix stored with every message
+        explicit MessageBuffer(std::size_t capacity);
+
+        // All or nothing; false when the message does not fit
+        bool send(const void *data, std::size_t length);
+
+        // Returns the message length, or 0 when no message is queued or the
+        // next one is larger than `max_length` (it is then left queued)
+        std::size_t receive(void *data, std::size_t max_length);
+
+        // Length of the next message, 0 when empty
+        std::size_t nextMessageLength() const;
+
+        bool waitForData() { return stream_.waitForData(); }
+        void setReader(const TaskPtr &task) { stream_.setReader(task); }
+
+        bool empty() const { return stream_.empty(); }
+        std::size_t spacesAvailable() const { return stream_.spacesAvailable(); }
+        std::size_t capacity() const { return stream_.capacity(); }
+        void reset() { stream_.reset(); }
+
+    private:
+        StreamBuffer stream_;
+    };
+
+} // namespace edurtos
@@ -5,9 +5,16 @@
 #include <memory>
 #include <string>
 #include <atomic>
+#include "wcet_estimator.hpp"
+#include "perf_counters.hpp"
 
 namespace edurtos
 {
+    class TaskEventBus;
+    template <typename Mutex>
+    class BasicReadyQueue;
+    template <typename Mutex>
+    class BasicEdfQueue;
 
     enum class TaskState
     {
@@ -24,6 +31,16 @@ namespace edurtos
         COOPERATIVE // Must yield voluntarily
     };
 
+    // How notify() updates the receiving task's notification value
+    enum class NotifyAction
+    {
+        NO_ACTION,                  // Only mark a notification pending
+        SET_BITS,                   // value |= bits (event group)
+        INCREMENT,                  // value += 1 (counting semaphore)
+        SET_VALUE_WITH_OVERWRITE,   // value = v (mailbox, latest wins)
+        SET_VALUE_WITHOUT_OVERWRITE // value = v unless a notification is pending
+    };
+
     struct TaskStatistics
     {
         std::size_t execution_count = 0;
@@ -31,6 +48,9 @@ namespace edurtos
         std::chrono::steady_clock::time_point last_execution{};
         std::chrono::microseconds total_execution_time{0};
         std::chrono::microseconds average_execution_time{0};
+        std::chrono::microseconds total_cpu_time{0};   // Thread CPU time, excludes sleeps
+        std::chrono::microseconds average_cpu_time{0};
+        PerfCounterValues perf_counters{}; // Totals over all jobs while counters are enabled
         std::chrono::milliseconds deadline_counter{0}; // New deadline counter
     };
 
@@ -39,10 +59,21 @@ namespace edurtos
 
     using Task = TaskBase<void>; // Default task specialization
 
+    // Notified after every successful state transition, on the thread that
+    // made it. Implementations must not block on locks held around task calls.
+    template <typename T = void>
+    class TaskStateListener
+    {
+    public:
+        virtual ~TaskStateListener() = default;
+        virtual void onTaskStateChange(TaskBase<T> &task, TaskState from, TaskState to) = 0;
+    };
+
     template <typename T>
-    class TaskBase
+    class TaskBase : public std::enable_shared_from_this<TaskBase<T>>
     {
     private:
+        std::uint32_t id_;
         std::string name_;
         std::function<void()> handler_;
         std::atomic<TaskState> state_{TaskState::READY};
@@ -51,10 +82,43 @@ namespace edurtos
         std::atomic<std::uint8_t> dynamic_priority_; // 1-99 scale
         std::chrono::milliseconds period_{0};
         std::chrono::milliseconds deadline_{0};
+        std::atomic<float> rate_scale_{1.0f}; // Elastic rate set by feedback control
         TaskStatistics statistics_{};
+        WcetEstimator wcet_estimator_;
         std::size_t stack_size_;
         bool recoverable_;
 
+        // Task whose handler is running on this thread
+        static thread_local TaskBase *current_;
+        static std::atomic<std::uint32_t> next_id_;
+
+        // Receive every state transition once the task is added to a scheduler
+        std::atomic<TaskEventBus *> event_bus_{nullptr};
+        std::atomic<TaskStateListener<T> *> state_listener_{nullptr};
+
+        bool changeState(TaskState state);
+        void notifyStateChange(TaskState from, TaskState to);
+
+        // Notification word: value in the low 32 bits, flags above it. A
+        // single atomic so notify() is lock-free and safe from ISR threads.
+        static constexpr std::uint64_t NOTIFY_PENDING = std::uint64_t{1} << 32;
+        static constexpr std::uint64_t NOTIFY_WAITING = std::uint64_t{1} << 33;
+        static constexpr std::uint64_t NOTIFY_VALUE_MASK = 0xFFFFFFFFull;
+        std::atomic<std::uint64_t> notification_{0};
+
+        void finishJob();
+
+        // Intrusive run-queue hooks, guarded by the owning queue's lock. The
+        // EDF queue only uses queued_.
+        template <typename Mutex>
+        friend class BasicReadyQueue;
+        template <typename Mutex>
+        friend class BasicEdfQueue;
+        TaskBase *queue_next_{nullptr};
+        TaskBase *queue_prev_{nullptr};
+        std::uint8_t queue_priority_{0};
+        bool queued_{false};
+
     public:
         TaskBase(std::string name,
                  std::function<void()> handler,
@@ -65,13 +129,57 @@ namespace edurtos
                  std::size_t stack_size = 4096,
                  bool recoverable = false);
 
-        // Core task operations
+        // Core task operations. Suspend, resume and terminate return false when
+        // the current state does not allow the move.
         void execute();
-        void suspend();
-        void resume();
-        void terminate();
+        bool suspend();
+        bool resume();
+        bool terminate();
+
+        // State machine: legal moves are
+        //   READY      -> RUNNING, BLOCKED, SUSPENDED, TERMINATED
+        //   RUNNING    -> READY, BLOCKED, SUSPENDED, TERMINATED
+        //   BLOCKED    -> READY, SUSPENDED, TERMINATED
+        //   SUSPENDED  -> READY, TERMINATED
+        //   TERMINATED -> READY (recovery)
+        static bool isLegalTransition(TaskState from, TaskState to);
+
+        // Compare-and-swap from `expected`; fails if another thread moved first
+        // or the move is illegal
+        bool tryTransition(TaskState expected, TaskState desired);
+
+        // Direct-to-task notification. Returns false only when
+        // SET_VALUE_WITHOUT_OVERWRITE finds a notification already pending.
+        // Wakes the task if it is blocked waiting for one.
+        bool notify(std::uint32_t value = 0, NotifyAction action = NotifyAction::INCREMENT);
+
+        // Called from the task's own handler. If a notification is pending,
+        // stores the value, clears `clear_bits_on_exit` and returns true.
+        // Otherwise the wait is armed and returns false: when the current job
+        // returns the task is BLOCKED until the next notify().
+        bool waitForNotification(std::uint32_t &value, std::uint32_t clear_bits_on_exit = 0xFFFFFFFF);
+
+        // Counting-semaphore form: returns the count and either clears it or
+        // decrements it by one. A zero count arms the wait as above.
+        std::uint32_t takeNotification(bool clear_count = true);
+
+        // Arms the wait only if no notification is pending, and consumes
+        // nothing: a pending one is left to whoever expects it and the task
+        // stays ready. Returns true if the wait was armed.
+        bool armNotificationWait();
+
+        bool isNotificationPending() const { return (notification_.load() & NOTIFY_PENDING) != 0; }
+        std::uint32_t getNotificationValue() const
+        {
+            return static_cast<std::uint32_t>(notification_.load() & NOTIFY_VALUE_MASK);
+        }
+
+        // Task whose handler is executing on the calling thread, or nullptr.
+        // Only reads a thread-local pointer, so it is safe in signal handlers.
+        static TaskBase *current();
 
         // Getters
+        std::uint32_t getId() const { return id_; } // Unique per process
         const std::string &getName() const { return name_; }
         TaskState getState() const { return state_; }
         SchedulePolicy getPolicy() const { return policy_; }
@@ -79,7 +187,14 @@ namespace edurtos
         std::uint8_t getDynamicPriority() const { return dynamic_priority_; }
         std::chrono::milliseconds getPeriod() const { return period_; }
         std::chrono::milliseconds getDeadline() const { return deadline_; }
+        float getRateScale() const { return rate_scale_; }
+        std::chrono::milliseconds getEffectivePeriod() const;
+        std::chrono::milliseconds getEffectiveDeadline() const;
         const TaskStatistics &getStatistics() const { return statistics_; }
+        WcetEstimate getWcetEstimate(double exceedance_probability = 1e-6) const
+        {
+            return wcet_estimator_.getEstimate(exceedance_probability);
+        }
         bool isRecoverable() const { return recoverable_; }
 
         // State update methods
@@ -90,8 +205,13 @@ namespace edurtos
         bool isDeadlineApproaching() const;
 
         // For scheduler use only
-        void setState(TaskState state) { state_ = state; }
-        void updateStatistics(std::chrono::microseconds execution_time);
+        bool setState(TaskState state) { return changeState(state); }
+        void setEventBus(TaskEventBus *bus) { event_bus_ = bus; }
+        void setStateListener(TaskStateListener<T> *listener) { state_listener_ = listener; }
+        void setRateScale(float scale) { rate_scale_ = scale; }
+        void addPerfCounters(const PerfCounterValues &values) { statistics_.perf_counters += values; }
+        void updateStatistics(std::chrono::microseconds execution_time,
+                              std::chrono::microseconds cpu_time);
     };
 
     using TaskPtr = std::shared_ptr<Task>;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "task.hpp"
+#include "bounded_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace edurtos
+{
+    // One task state transition
+    struct TaskEvent
+    {
+        std::uint64_t timestamp_ns = 0; // steady_clock
+        std::uint32_t task_id = 0;
+        TaskState from = TaskState::READY;
+        TaskState to = TaskState::READY;
+
+        std::chrono::steady_clock::time_point getTimestamp() const
+        {
+            return std::chrono::steady_clock::time_point(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+        }
+    };
+
+    // Per-subscriber bounded queue. When the consumer falls behind, new events
+    // are dropped and counted rather than blocking the publishing task.
+    class TaskEventSubscription
+    {
+    public:
+        explicit TaskEventSubscription(std::size_t capacity);
+
+        // Move up to max_events queued events into `out`
+        std::size_t poll(std::vector<TaskEvent> &out, std::size_t max_events = SIZE_MAX);
+
+        // Block until at least `min_batch` events are queued or the timeout
+        // expires; publishers only signal once a full batch is waiting
+        bool waitForEvents(std::chrono::milliseconds timeout, std::size_t min_batch = 1);
+
+        std::uint64_t getReceivedCount() const { return received_; }
+        std::uint64_t getDroppedCount() const { return dropped_; }
+        std::size_t getQueuedCount() const { return queue_.size(); }
+
+    private:
+        friend class TaskEventBus;
+
+        void push(const TaskEvent &event);
+
+        BoundedQueue<TaskEvent> queue_;
+        std::atomic<std::uint64_t> received_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+
+        // Wakeup for blocked consumers; untouched while nobody waits
+        std::atomic<std::size_t> wake_threshold_{0}; // 0 = no waiter
+        std::mutex wait_mutex_;
+        std::condition_variable wait_cv_;
+    };
+
+    using TaskEventSubscriptionPtr = std::shared_ptr<TaskEventSubscription>;
+
+    // Publish/subscribe bus for task state transitions. Publishing is one
+    // acquire load plus a push per subscriber: the subscriber list is an
+    // immutable copy replaced on (rare) subscribe/unsubscribe, and each
+    // subscriber has its own lock-free queue. Replaced lists are kept until the
+    // bus is destroyed because a publisher may still be walking one, so an
+    // unsubscribed subscription is only released together with the bus.
+    class TaskEventBus
+    {
+    public:
+        TaskEventBus();
+        TaskEventBus(const TaskEventBus &) = delete;
+        TaskEventBus &operator=(const TaskEventBus &) = delete;
+
+        TaskEventSubscriptionPtr subscribe(std::size_t capacity = 1024);
+        void unsubscribe(const TaskEventSubscriptionPtr &subscription);
+
+        void publish(const TaskEvent &event);
+        void publish(std::uint32_t task_id, TaskState from, TaskState to);
+
+        bool hasSubscribers() const { return has_subscribers_.load(std::memory_order_relaxed); }
+        std::uint64_t getPublishedCount() const { return published_; }
+
+    private:
+        using SubscriberList = std::vector<TaskEventSubscriptionPtr>;
+
+        // Publishers read through the raw pointer; lists_ owns every version
+        std::atomic<const SubscriberList *> subscribers_{nullptr};
+        std::vector<std::unique_ptr<const SubscriberList>> lists_;
+        std::atomic<bool> has_subscribers_{false};
+        std::atomic<std::uint64_t> published_{0};
+        std::mutex update_mutex_; // Serializes subscribe/unsubscribe only
+
+        void replaceSubscribers(std::unique_ptr<const SubscriberList> updated);
+    };
+
+} // namespace edurtos
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "task.hpp"
+#include "wake_source.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace edurtos
+{
+    // Publish/subscribe topic for one publisher and any number of readers.
+    //
+    // Samples live in a fixed ring of slots, each guarded by a sequence number
+    // (a seqlock). Subscribers read a slot in place and then check that its
+    // sequence did not change, so nothing is copied per subscriber and a
+    // publish costs the same however many subscribers there are. The
+    // publisher never waits: a subscriber that falls a full ring behind skips
+    // ahead and the skipped samples are counted as overruns.
+    //
+    // Subscribers with a reader task can block in waitForData(). Publishing
+    // then only raises a deferred wakeup; the scheduler thread notifies the
+    // waiting tasks.
+    template <typename T>
+    class Topic : public WakeSource
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Topic samples are read while they may be overwritten");
+
+    public:
+        class Subscription
+        {
+        public:
+            Subscription(Topic &topic, std::uint64_t cursor, const TaskPtr &reader)
+                : topic_(topic), cursor_(cursor), reader_(reader)
+            {
+            }
+
+            // Call `reader(const T &)` on the oldest unread sample, in place.
+            // Returns false when there is nothing new. Like any seqlock read it
+            // is retried if the publisher overwrote the slot meanwhile, so
+            // `reader` may run more than once and only the last call counts.
+            template <typename F>
+            bool read(F &&reader)
+            {
+                return topic_.readAt(*this, std::forward<F>(reader));
+            }
+
+            // Skip to the newest sample; skipped samples are not overruns
+            template <typename F>
+            bool readLatest(F &&reader)
+            {
+                std::uint64_t newest = topic_.next_sequence_.load(std::memory_order_acquire) - 1;
+                if (newest > cursor_)
+                {
+                    cursor_ = newest;
+                }
+                return read(std::forward<F>(reader));
+            }
+
+            bool hasData() const { return topic_.isPublished(cursor_); }
+
+            // Called by the reader task's handler. Returns true if a sample is
+            // waiting; otherwise arms a wait so the task blocks when its job
+            // returns and is woken by the scheduler after the next publish.
+            // The task's notification value is left to other notifiers.
+            bool waitForData()
+            {
+                if (hasData())
+                {
+                    return true;
+                }
+
+                if (!waiting_.exchange(true))
+                {
+                    topic_.waiters_.fetch_add(1);
+                }
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (hasData())
+                {
+                    cancelWait();
+                    return true;
+                }
+
+                // Consumes only the pending flag, as StreamBuffer does
+                if (Task *self = Task::current())
+                {
+                    std::uint32_t value;
+                    self->waitForNotification(value, 0);
+                }
+                return false;
+            }
+
+            std::uint64_t getReadCount() const { return reads_; }
+            std::uint64_t getOverrunCount() const { return overruns_; }
+
+        private:
+            friend class Topic;
+
+            bool cancelWait()
+            {
+                if (waiting_.exchange(false))
+                {
+                    topic_.waiters_.fetch_sub(1);
+                    return true;
+                }
+                return false;
+            }
+
+            Topic &topic_;
+            std::uint64_t cursor_; // Next sequence to read; owned by the reader
+            std::weak_ptr<Task> reader_;
+            std::atomic<bool> waiting_{false};
+            std::atomic<std::uint64_t> reads_{0};
+            std::atomic<std::uint64_t> overruns_{0};
+        };
+
+        using SubscriptionPtr = std::shared_ptr<Subscription>;
+
+        // Capacity is rounded up to a power of two
+        explicit Topic(std::string name, std::size_t capacity = 16)
+            : name_(std::move(name))
+        {
+            capacity_ = 2;
+            while (capacity_ < capacity)
+            {
+                capacity_ <<= 1;
+            }
+            mask_ = capacity_ - 1;
+            slots_ = std::make_unique<Slot[]>(capacity_);
+        }
+
+        ~Topic() override { detachScheduler(); }
+
+        Topic(const Topic &) = delete;
+        Topic &operator=(const Topic &) = delete;
+
+        // Write the next sample directly into its slot: `fill(T &)`.
+        // Returns the sample's sequence number.
+        template <typename F>
+        std::uint64_t publishInPlace(F &&fill)
+        {
+            std::uint64_t sequence = next_sequence_.load(std::memory_order_relaxed);
+            Slot &slot = slots_[sequence & mask_];
+
+            // Odd while writing, so readers of the old sample detect the overwrite
+            slot.sequence.store((sequence << 1) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            fill(slot.value);
+            slot.sequence.store(sequence << 1, std::memory_order_release);
+            next_sequence_.store(sequence + 1, std::memory_order_release);
+
+            // One load when nobody waits, one coalesced request when someone does
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_relaxed) > 0)
+            {
+                requestWakeup();
+            }
+            return sequence;
+        }
+
+        std::uint64_t publish(const T &value)
+        {
+            return publishInPlace([&value](T &slot)
+                                  { slot = value; });
+        }
+
+        // New subscribers start at the next sample. `reader` is woken by the
+        // scheduler once the topic is added with Scheduler::addWakeSource().
+        SubscriptionPtr subscribe(const TaskPtr &reader = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            auto subscription = std::make_shared<Subscription>(
+                *this, next_sequence_.load(std::memory_order_acquire), reader);
+            subscriptions_.push_back(subscription);
+            return subscription;
+        }
+
+        void unsubscribe(const SubscriptionPtr &subscription)
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            subscription->cancelWait();
+            subscriptions_.erase(std::remove(subscriptions_.begin(), subscriptions_.end(), subscription),
+                                 subscriptions_.end());
+        }
+
+        const std::string &getName() const { return name_; }
+        std::size_t capacity() const { return capacity_; }
+        std::uint64_t getPublishedCount() const { return next_sequence_.load() - 1; }
+
+        std::uint64_t getOverrunCount() const
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            std::uint64_t total = 0;
+            for (const auto &subscription : subscriptions_)
+            {
+                total += subscription->getOverrunCount();
+            }
+            return total;
+        }
+
+    protected:
+        void processWakeups() override
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            for (const auto &subscription : subscriptions_)
+            {
+                if (subscription->waiting_.load() && subscription->hasData() && subscription->cancelWait())
+                {
+                    if (auto reader = subscription->reader_.lock())
+                    {
+                        reader->notify(0, NotifyAction::NO_ACTION);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<std::uint64_t> sequence{0}; // (n << 1) once sample n is complete
+            T value{};
+        };
+
+        bool isPublished(std::uint64_t sequence) const
+        {
+            return slots_[sequence & mask_].sequence.load(std::memory_order_acquire) >= (sequence << 1);
+        }
+
+        template <typename F>
+        bool readAt(Subscription &subscription, F &&reader)
+        {
+            for (;;)
+            {
+                std::uint64_t cursor = subscription.cursor_;
+                const Slot &slot = slots_[cursor & mask_];
+                std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+
+                if (before < (cursor << 1) || before == ((cursor << 1) | 1))
+                {
+                    return false; // Not published yet
+                }
+
+                if (before == (cursor << 1))
+                {
+                    reader(static_cast<const T &>(slot.value));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (slot.sequence.load(std::memory_order_relaxed) == before)
+                    {
+                        subscription.cursor_ = cursor + 1;
+                        subscription.reads_.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+
+                // Lapped by the publisher: resume at the oldest sample that
+                // cannot be overwritten before we get to it
+                std::uint64_t next = next_sequence_.load(std::memory_order_acquire);
+                std::uint64_t resume = std::max(cursor + 1, next > capacity_ ? next - capacity_ + 1 : 1);
+                subscription.overruns_.fetch_add(resume - cursor, std::memory_order_relaxed);
+                subscription.cursor_ = resume;
+            }
+        }
+
+        std::string name_;
+        std::size_t capacity_;
+        std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_;
+
+        alignas(64) std::atomic<std::uint64_t> next_sequence_{1}; // Written by the publisher only
+        alignas(64) std::atomic<std::uint32_t> waiters_{0};
+
+        mutable std::mutex subscriptions_mutex_; // Subscribe/unsubscribe and wakeups only
+        std::vector<SubscriptionPtr> subscriptions_;
+    };
+
+} // namespace edurtos
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+
+namespace edurtos
+{
+    class WakeSource;
+
+    template <typename Queue, typename Preemption, typename Lock>
+    class BasicScheduler;
+
+    // Side of a scheduler that wake sources talk to, whatever its policies
+    class WakeSourceHost
+    {
+    public:
+        virtual void signalWakeSources() = 0;
+        virtual void removeWakeSource(WakeSource &source) = 0;
+
+    protected:
+        ~WakeSourceHost() = default;
+    };
+
+    // Source of deferred task wakeups. Producers call requestWakeup() from any
+    // thread at O(1) cost; the scheduler thread later calls processWakeups()
+    // once for all requests made since, and does the per-task work there.
+    class WakeSource
+    {
+    public:
+        virtual ~WakeSource() = default;
+
+        bool isAttached() const { return scheduler_.load() != nullptr; }
+
+    protected:
+        // Coalesced: repeated requests before the scheduler runs cost one flag test
+        void requestWakeup();
+
+        // Runs on the scheduler thread
+        virtual void processWakeups() = 0;
+
+        // Derived classes call this from their destructor, while
+        // processWakeups() is still callable
+        void detachScheduler();
+
+    private:
+        template <typename Queue, typename Preemption, typename Lock>
+        friend class BasicScheduler;
+
+        std::atomic<WakeSourceHost *> scheduler_{nullptr};
+        std::atomic<bool> wake_requested_{false};
+    };
+
+} // namespace edurtos
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace edurtos
+{
+    // Streaming quantile estimator (Jain & Chlamtac P-square algorithm).
+    // Keeps five markers, so memory and update cost are O(1).
+    class P2Quantile
+    {
+    public:
+        explicit P2Quantile(double probability);
+
+        void add(double sample);
+        double value() const;
+        std::size_t count() const { return count_; }
+        void reset();
+
+    private:
+        double probability_;
+        std::size_t count_{0};
+        std::array<double, 5> heights_{};
+        std::array<double, 5> positions_{};
+        std::array<double, 5> desired_{};
+        std::array<double, 5> increments_{};
+
+        double parabolic(int i, double d) const;
+        double linear(int i, int d) const;
+    };
+
+    // Gumbel (extreme value type I) fit over block maxima, updated with Welford's method
+    class GumbelFit
+    {
+    public:
+        explicit GumbelFit(std::size_t block_size = 20);
+
+        void add(double sample);
+        void reset();
+
+        bool isValid() const { return blocks_ >= 2; }
+        double location() const;
+        double scale() const;
+
+        // Value exceeded by a single sample with the given probability
+        double quantile(double exceedance_probability) const;
+
+    private:
+        std::size_t block_size_;
+        std::size_t block_fill_{0};
+        double block_max_{0.0};
+        std::size_t blocks_{0};
+        double mean_{0.0};
+        double m2_{0.0};
+    };
+
+    // Execution-time bounds for one task
+    struct WcetEstimate
+    {
+        std::size_t samples = 0;
+        std::chrono::microseconds observed_max{0};
+        std::chrono::microseconds p50{0};
+        std::chrono::microseconds p90{0};
+        std::chrono::microseconds p99{0};
+        double gumbel_location_us = 0.0;
+        double gumbel_scale_us = 0.0;
+        double exceedance_probability = 0.0;
+        std::chrono::microseconds probabilistic_wcet{0}; // Falls back to observed_max until fitted
+    };
+
+    // Per-task online WCET estimator combining streaming quantiles and an EVT fit
+    class WcetEstimator
+    {
+    public:
+        WcetEstimator();
+
+        void addSample(std::chrono::microseconds execution_time);
+        void reset();
+
+        WcetEstimate getEstimate(double exceedance_probability = 1e-6) const;
+
+    private:
+        mutable std::mutex mutex_;
+        P2Quantile p50_{0.50};
+        P2Quantile p90_{0.90};
+        P2Quantile p99_{0.99};
+        GumbelFit gumbel_;
+        std::size_t samples_{0};
+        double max_{0.0};
+    };
+
+} // namespace edurtos
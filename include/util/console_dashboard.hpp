@@ -10,6 +10,7 @@
 #include <atomic>
 #include <mutex>
 #include <memory>
+#include <deque>
 
 namespace edurtos
 {
@@ -76,6 +77,12 @@ namespace edurtos
             std::atomic<bool> is_running_{false};
             std::mutex dashboard_mutex_;
 
+            // Redraw when tasks change state instead of on a fixed timer
+            static constexpr std::chrono::milliseconds IDLE_REFRESH{1000};
+            static constexpr std::size_t RECENT_TRANSITIONS = 5;
+            TaskEventSubscriptionPtr subscription_;
+            std::deque<TaskEvent> recent_transitions_;
+
             // Dashboard loop method
             void dashboardLoop();
 
@@ -88,9 +95,10 @@ namespace edurtos
 
             // Dashboard rendering methods
             void renderHeader();
-            void renderTaskList();
-            void renderTaskDetails();
-            void renderCpuUtilization();
+            void renderTaskList(const SchedulerSnapshot &snapshot);
+            void renderTaskDetails(const SchedulerSnapshot &snapshot);
+            void renderCpuUtilization(const SchedulerSnapshot &snapshot);
+            void renderTransitions(const SchedulerSnapshot &snapshot);
             std::string generateProgressBar(float percentage, int width, const std::string &fill_char = "=",
                                             const std::string &empty_char = " ");
         };
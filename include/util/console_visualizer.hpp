@@ -1,7 +1,11 @@
 #pragma once
 
 #include "../kernel/task.hpp"
+#include "../kernel/scheduler.hpp"
+#include "../kernel/scheduler_snapshot.hpp"
+#include "../kernel/task_event_bus.hpp"
 #include <vector>
+#include <deque>
 #include <string>
 #include <map>
 #include <memory>
@@ -24,6 +28,7 @@ namespace edurtos
             };
 
             ConsoleVisualizer();
+            ~ConsoleVisualizer();
 
             // Configure display options
             void setDisplayMode(DisplayMode mode);
@@ -35,6 +40,10 @@ namespace edurtos
             void addTask(TaskPtr task, char symbol = '\0');
             void removeTask(const std::string &task_name);
 
+            // Read task state from the scheduler's shared snapshot instead of
+            // polling each task, and record every transition for the timeline
+            void attachScheduler(Scheduler &scheduler);
+
             // Generate visualization
             std::string generateTaskStateVisualization();
             std::string generateTaskTimelineVisualization(std::chrono::seconds duration);
@@ -50,6 +59,8 @@ namespace edurtos
             bool show_deadlines_{true};
             std::map<TaskPtr, char> task_symbols_;
             std::chrono::steady_clock::time_point last_refresh_;
+            Scheduler *scheduler_{nullptr};
+            TaskEventSubscriptionPtr subscription_;
 
             // Timeline tracking
             struct TimelineEvent
@@ -59,14 +70,17 @@ namespace edurtos
                 TaskState previous_state;
                 TaskState new_state;
             };
-            std::vector<TimelineEvent> timeline_events_;
+            std::deque<TimelineEvent> timeline_events_;
 
             // Utility functions
             char getDefaultSymbol(size_t index) const;
             std::string getTaskSymbol(TaskPtr task) const;
             std::string getTaskStateChar(TaskState state) const;
             std::string generateProgressBar(float percentage, int width = 20) const;
-            void recordTaskStateChange(TaskPtr task, TaskState previous, TaskState current);
+            std::shared_ptr<const SchedulerSnapshot> takeSnapshot() const;
+            void recordTaskStateChange(TaskPtr task, TaskState previous, TaskState current,
+                                       std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now());
+            void drainEvents();
         };
 
     } // namespace util
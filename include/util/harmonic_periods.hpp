@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../kernel/task.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        struct PeriodRequirement
+        {
+            std::string name;
+            std::chrono::microseconds period{0}; // Longest acceptable period
+            std::chrono::microseconds wcet{0};
+
+            // Requirement of a live task: its period and probabilistic WCET estimate
+            static PeriodRequirement fromTask(const Task &task);
+        };
+
+        struct PeriodSuggestion
+        {
+            std::string name;
+            std::chrono::microseconds period{0};    // As requested
+            std::chrono::microseconds suggested{0}; // Not longer than requested, above the granularity
+        };
+
+        struct HarmonicPlan
+        {
+            std::vector<PeriodSuggestion> tasks; // In input order
+            std::chrono::microseconds base_period{0};
+            std::chrono::microseconds hyperperiod{0};           // Of the requested periods
+            std::chrono::microseconds suggested_hyperperiod{0}; // Longest suggested period
+            double utilization = 0.0;                           // Percent, requested periods
+            double suggested_utilization = 0.0;                 // Percent, suggested periods
+            std::size_t release_groups = 0;                     // Distinct suggested periods
+
+            // Harmonic periods under fixed priorities are schedulable up to
+            // 100% utilization (the rate-monotonic bound for harmonic sets)
+            bool schedulable() const { return suggested_utilization <= 100.0; }
+        };
+
+        // Suggests harmonic periods: each task gets the longest period of the
+        // form base * 2^k that does not exceed its requested period, so every
+        // period divides all longer ones. Periods are only shortened, which
+        // keeps every rate requirement met, at the cost of extra utilization;
+        // the base is chosen to minimize that cost (the Sr algorithm of Han and
+        // Tyan). Harmonic periods make the hyperperiod the longest period and
+        // let the scheduler release coinciding period groups in one batch.
+        //
+        // The base is rounded down to `granularity`, so the default gives
+        // periods a Task accepts as milliseconds; periods shorter than the
+        // granularity are rounded up to it. Tasks without a period are left out.
+        HarmonicPlan suggestHarmonicPeriods(const std::vector<PeriodRequirement> &requirements,
+                                            std::chrono::microseconds granularity = std::chrono::milliseconds(1));
+
+        // Table of the plan for the console
+        std::string formatHarmonicPlan(const HarmonicPlan &plan);
+
+    } // namespace util
+} // namespace edurtos
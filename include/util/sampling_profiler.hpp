@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../kernel/bounded_queue.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        struct ProfilerConfig
+        {
+            // Samples per second of consumed process CPU time. Prime rates avoid
+            // lockstep with periodic tasks; a few hundred Hz is cheap enough to
+            // leave enabled.
+            unsigned int frequency_hz = 99;
+
+            // Walk frame pointers for folded stacks. Only enable this when the
+            // whole program is built with -fno-omit-frame-pointer: the walk
+            // runs in the signal handler, and a register reused as data can
+            // point anywhere within the stack span it trusts.
+            bool capture_stacks = false;
+            std::size_t max_stack_depth = 32;
+
+            // Samples buffered between collector passes; extra samples are dropped
+            std::size_t buffer_size = 8192;
+        };
+
+        struct ProfilerStatistics
+        {
+            std::uint64_t samples = 0;
+            std::uint64_t dropped_samples = 0;
+            double average_handler_ns = 0.0;
+            std::uint64_t max_handler_ns = 0;
+        };
+
+        // SIGPROF-driven sampling profiler. Each sample records the EduRTOS task
+        // executing on the interrupted thread and, optionally, its call stack.
+        // The signal handler only copies into a preallocated lock-free queue; a
+        // collector thread aggregates and symbolizes samples off the hot path.
+        class SamplingProfiler
+        {
+        public:
+            static constexpr std::size_t MAX_STACK_DEPTH = 64;
+            static constexpr std::size_t TASK_NAME_SIZE = 32;
+
+            static SamplingProfiler &getInstance();
+
+            // Linux/POSIX only; returns false on Windows
+            bool start(const ProfilerConfig &config = ProfilerConfig{});
+            void stop();
+            bool isRunning() const { return is_running_; }
+
+            // Clear aggregated profiles and statistics
+            void reset();
+
+            // Flat profile: samples per task (CSV)
+            bool writeFlatProfile(const std::string &filename);
+
+            // Folded stacks ("task;outer;...;inner count") for flamegraph.pl,
+            // speedscope and similar tools
+            bool writeFoldedStacks(const std::string &filename);
+
+            std::map<std::string, std::uint64_t> getFlatProfile();
+            ProfilerStatistics getStatistics();
+
+        private:
+            struct Sample
+            {
+                std::array<char, TASK_NAME_SIZE> task_name{};
+                std::uint32_t depth = 0;
+                std::array<std::uintptr_t, MAX_STACK_DEPTH> stack{};
+            };
+
+            SamplingProfiler();
+            ~SamplingProfiler();
+            SamplingProfiler(const SamplingProfiler &) = delete;
+            SamplingProfiler &operator=(const SamplingProfiler &) = delete;
+
+            static void handleSignal(void *ucontext);
+            void recordSample(void *ucontext);
+
+            void collectorLoop();
+            void collect();
+            const std::string &symbolize(std::uintptr_t address);
+
+            ProfilerConfig config_;
+            std::unique_ptr<BoundedQueue<Sample>> samples_; // Allocated by start()
+            std::atomic<bool> is_running_{false};
+            std::thread collector_thread_;
+
+            // Written by the signal handler
+            std::atomic<std::uint64_t> dropped_samples_{0};
+            std::atomic<std::uint64_t> handler_ns_total_{0};
+            std::atomic<std::uint64_t> handler_ns_max_{0};
+            std::atomic<std::uint64_t> handler_calls_{0};
+
+            // Aggregated by the collector
+            std::mutex profile_mutex_;
+            std::uint64_t collected_samples_{0};
+            std::map<std::string, std::uint64_t> flat_profile_;
+            std::unordered_map<std::string, std::uint64_t> folded_stacks_;
+            std::unordered_map<std::uintptr_t, std::string> symbol_cache_;
+        };
+
+    } // namespace util
+} // namespace edurtos
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../kernel/task.hpp"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        // Execution-time distribution sampled by the simulator
+        class ExecutionTimeDistribution
+        {
+        public:
+            // Always the same execution time
+            static ExecutionTimeDistribution constant(std::chrono::microseconds execution_time);
+
+            // Resample measured execution times
+            static ExecutionTimeDistribution fromSamples(std::vector<std::chrono::microseconds> samples);
+
+            // Piecewise-linear inverse CDF through the estimator's quantiles,
+            // reaching the probabilistic WCET in the upper tail
+            static ExecutionTimeDistribution fromEstimate(const WcetEstimate &estimate);
+
+            std::chrono::microseconds sample(std::mt19937_64 &rng) const;
+
+        private:
+            enum class Kind
+            {
+                CONSTANT,
+                EMPIRICAL,
+                QUANTILES
+            };
+
+            Kind kind_{Kind::CONSTANT};
+            std::vector<std::chrono::microseconds> samples_;
+            std::vector<std::pair<double, double>> quantiles_; // (probability, microseconds)
+        };
+
+        struct SimulatedTask
+        {
+            std::string name;
+            std::uint8_t priority = 50;
+            std::chrono::microseconds period{0};
+            std::chrono::microseconds deadline{0}; // 0 = implicit deadline (period)
+            std::chrono::microseconds offset{0};   // First release
+            ExecutionTimeDistribution execution_time;
+
+            // Model of a live task from its period, deadline and measured
+            // execution times
+            static SimulatedTask fromTask(const Task &task);
+        };
+
+        struct SimulationConfig
+        {
+            std::chrono::microseconds duration{std::chrono::seconds(10)}; // Virtual time per run
+            std::size_t runs = 1000;
+            std::uint64_t seed = 1;
+            unsigned int threads = 0; // 0 = one per host core
+
+            // Dispatcher cost charged before every job
+            std::chrono::microseconds dispatch_overhead{0};
+
+            // Poisson interrupt arrivals that preempt whatever is running
+            double interrupt_rate_hz = 0.0;
+            ExecutionTimeDistribution interrupt_service_time;
+
+            // Probability that a job faults. A faulted job is aborted partway,
+            // charges the recovery time, and counts as a deadline miss.
+            double fault_probability = 0.0;
+            std::chrono::microseconds fault_recovery_time{0};
+        };
+
+        struct TaskSimulationResult
+        {
+            std::string name;
+            std::uint64_t jobs = 0;
+            std::uint64_t deadline_misses = 0;
+            std::uint64_t faults = 0;
+            double miss_probability = 0.0;     // Missed jobs / released jobs
+            double run_miss_probability = 0.0; // Runs with at least one miss
+            std::chrono::microseconds response_mean{0};
+            std::chrono::microseconds response_p50{0};
+            std::chrono::microseconds response_p90{0};
+            std::chrono::microseconds response_p99{0};
+            std::chrono::microseconds response_p999{0};
+            std::chrono::microseconds response_max{0};
+        };
+
+        struct SimulationResult
+        {
+            std::size_t runs = 0;
+            std::uint64_t seed = 0;
+            unsigned int threads = 0;
+            std::uint64_t interrupts = 0;
+            double average_utilization = 0.0; // Percentage of virtual time busy
+            std::chrono::milliseconds wall_time{0};
+            std::vector<TaskSimulationResult> tasks;
+        };
+
+        // Monte Carlo schedule simulator. Each run replays the task set on an
+        // independent dispatcher model in virtual time, with no Kernel or
+        // Scheduler instance and no sleeping, so thousands of runs take seconds.
+        // Runs are spread across host threads; every run is seeded from the base
+        // seed and its index, so results do not depend on the thread count.
+        //
+        // The model is an idealized fixed-priority, run-to-completion
+        // dispatcher: every job is released exactly at its period, jobs run in
+        // base priority order and only interrupts preempt them. It does not
+        // model the real scheduler's priority boost after deadline misses
+        // (Task::updatePriority()), nor that periods are only enforced in
+        // feedback mode, so treat its results as a bound for a well-behaved
+        // task set rather than a replay of Scheduler.
+        class ScheduleSimulator
+        {
+        public:
+            explicit ScheduleSimulator(SimulationConfig config = SimulationConfig{});
+
+            bool addTask(const SimulatedTask &task);
+            void clearTasks();
+
+            void setConfig(const SimulationConfig &config);
+            const SimulationConfig &getConfig() const { return config_; }
+
+            SimulationResult run() const;
+
+            // Per-task results as CSV
+            static bool writeResults(const SimulationResult &result, const std::string &filename);
+
+        private:
+            struct RunResult;
+
+            SimulationConfig config_;
+            std::vector<SimulatedTask> tasks_;
+
+            RunResult simulateRun(std::size_t run_index) const;
+        };
+
+    } // namespace util
+} // namespace edurtos
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <atomic>
 #include <thread>
+#include <vector>
 
 namespace edurtos
 {
@@ -34,6 +35,9 @@ namespace edurtos
             // Flush log to disk
             void flush();
 
+            // Write per-task execution-time bounds to a separate CSV file
+            bool writeWcetReport(const std::string &filename, double exceedance_probability = 1e-6);
+
         private:
             // Reference to scheduler
             Scheduler &scheduler_;
@@ -47,13 +51,24 @@ namespace edurtos
             std::atomic<bool> is_running_{false};
             std::chrono::milliseconds logging_interval_{100}; // Default 100ms
             std::thread logging_thread_;
+            std::chrono::steady_clock::time_point last_feedback_sample_{};
+
+            // Every state transition, pushed by the scheduler's event bus
+            static constexpr std::size_t EVENT_QUEUE_CAPACITY = 4096;
+            static constexpr std::size_t EVENT_BATCH_SIZE = 64;
+            TaskEventSubscriptionPtr subscription_;
+            std::vector<TaskEvent> event_buffer_;
+            std::uint64_t reported_drops_{0};
 
             // Logging methods
             void loggingLoop();
             void writeHeader();
             void logSchedulerState();
-            void logTaskState(const TaskPtr &task, const std::string &event);
+            void logTaskState(const TaskSnapshot &task, const std::string &event);
+            void logFeedbackControl(const FeedbackSample &sample);
+            void logTransitions();
             std::string getCurrentTimestamp() const;
+            static std::string formatTimestamp(std::chrono::system_clock::time_point time);
         };
 
     } // namespace util
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Tracepoints compile to nothing unless EDURTOS_ENABLE_TRACING is defined
+// (CMake option EDURTOS_TRACING). When compiled in, each tracepoint costs one
+// relaxed load of a category mask until tracing is switched on at runtime.
+//
+// With EDURTOS_ENABLE_USDT (CMake option EDURTOS_USDT) every tracepoint is also
+// a USDT probe "edurtos_<provider>:<name>" that perf and bpftrace can attach to.
+
+#if defined(EDURTOS_ENABLE_USDT) && defined(__linux__) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define EDURTOS_USDT_PROBE(provider, name, ...) STAP_PROBEV(edurtos_##provider, name __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define EDURTOS_USDT_PROBE(provider, name, ...) ((void)0)
+#endif
+
+#ifdef EDURTOS_ENABLE_TRACING
+#define EDURTOS_TRACE(category, provider, name, ...)                                               \
+    do                                                                                             \
+    {                                                                                              \
+        EDURTOS_USDT_PROBE(provider, name __VA_OPT__(, ) __VA_ARGS__);                             \
+        if (::edurtos::util::Tracer::isEnabled(::edurtos::util::TraceCategory::category)) [[unlikely]] \
+        {                                                                                          \
+            ::edurtos::util::Tracer::getInstance().emit(::edurtos::util::TraceCategory::category,  \
+                                                        #provider, #name __VA_OPT__(, ) __VA_ARGS__); \
+        }                                                                                          \
+    } while (0)
+#else
+#define EDURTOS_TRACE(category, provider, name, ...) \
+    do                                               \
+    {                                                \
+    } while (0)
+#endif
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        enum class TraceCategory : std::uint32_t
+        {
+            SCHEDULER = 1u << 0,
+            TASK = 1u << 1,
+            DRIVER = 1u << 2,
+            FAULT = 1u << 3,
+            ALL = 0xFFFFFFFFu
+        };
+
+        // One recorded tracepoint hit. Provider and name point to string literals.
+        struct TraceRecord
+        {
+            std::uint64_t timestamp_ns = 0;
+            std::uint64_t sequence = 0;
+            TraceCategory category = TraceCategory::ALL;
+            const char *provider = "";
+            const char *name = "";
+            std::uint8_t arg_count = 0;
+            std::array<std::uint64_t, 4> args{};
+        };
+
+        // Flight recorder behind the tracepoints: a fixed ring that writers never
+        // block on. Old records are overwritten when readers fall behind.
+        class Tracer
+        {
+        public:
+            static constexpr std::size_t RING_SIZE = 4096; // Power of two
+
+            static Tracer &getInstance();
+
+            // The single flag every compiled-in tracepoint checks
+            static bool isEnabled(TraceCategory category)
+            {
+                return (enabled_mask_.load(std::memory_order_relaxed) & static_cast<std::uint32_t>(category)) != 0;
+            }
+
+            static void enable(TraceCategory category = TraceCategory::ALL);
+            static void disable(TraceCategory category = TraceCategory::ALL);
+            static constexpr bool isCompiledIn()
+            {
+#ifdef EDURTOS_ENABLE_TRACING
+                return true;
+#else
+                return false;
+#endif
+            }
+
+            template <typename... Args>
+            void emit(TraceCategory category, const char *provider, const char *name, Args... args)
+            {
+                static_assert(sizeof...(Args) <= 4, "Tracepoints take at most four arguments");
+
+                std::uint64_t sequence = head_.fetch_add(1, std::memory_order_relaxed);
+                Slot &slot = ring_[sequence & (RING_SIZE - 1)];
+
+                // Odd marker while the record is being written
+                slot.marker.store(sequence * 2 + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                slot.record.timestamp_ns = now();
+                slot.record.sequence = sequence;
+                slot.record.category = category;
+                slot.record.provider = provider;
+                slot.record.name = name;
+                slot.record.arg_count = static_cast<std::uint8_t>(sizeof...(Args));
+                std::size_t index = 0;
+                ((slot.record.args[index++] = toArg(args)), ...);
+
+                slot.marker.store(sequence * 2 + 2, std::memory_order_release);
+            }
+
+            // Move all records written since the last drain into `out`
+            std::size_t drain(std::vector<TraceRecord> &out);
+            bool writeToFile(const std::string &filename);
+
+            std::uint64_t getDroppedCount() const { return dropped_.load(); }
+
+        private:
+            Tracer() = default;
+            Tracer(const Tracer &) = delete;
+            Tracer &operator=(const Tracer &) = delete;
+
+            struct Slot
+            {
+                std::atomic<std::uint64_t> marker{0};
+                TraceRecord record;
+            };
+
+            template <typename T>
+            static std::uint64_t toArg(T value)
+            {
+                if constexpr (std::is_pointer_v<T>)
+                {
+                    return reinterpret_cast<std::uintptr_t>(value);
+                }
+                else if constexpr (std::is_enum_v<T>)
+                {
+                    return static_cast<std::uint64_t>(value);
+                }
+                else if constexpr (std::is_floating_point_v<T>)
+                {
+                    // Keep three decimals in a fixed-point integer
+                    return static_cast<std::uint64_t>(static_cast<std::int64_t>(value * 1000.0));
+                }
+                else
+                {
+                    return static_cast<std::uint64_t>(value);
+                }
+            }
+
+            static std::uint64_t now();
+
+            static inline std::atomic<std::uint32_t> enabled_mask_{0};
+
+            std::array<Slot, RING_SIZE> ring_{};
+            std::atomic<std::uint64_t> head_{0};
+            std::uint64_t tail_{0};
+            std::atomic<std::uint64_t> dropped_{0};
+        };
+
+    } // namespace util
+} // namespace edurtos
@@ -0,0 +1,355 @@
+#include "../../include/drivers/interrupt_controller.hpp"
+#include "../../include/kernel/host_thread.hpp"
+#include "../../include/util/trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <stdexcept>
+
+namespace edurtos
+{
+    namespace drivers
+    {
+        namespace
+        {
+            std::int64_t nowNs()
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+            }
+        }
+
+        // One host priority per level, plus one above them for the timer thread
+        static_assert(VirtualInterruptController::PRIORITY_LEVELS + 1 <= REALTIME_PRIORITY_MAX);
+
+        thread_local bool VirtualInterruptController::in_interrupt_ = false;
+
+        VirtualInterruptController::~VirtualInterruptController()
+        {
+            stop();
+        }
+
+        void VirtualInterruptController::start()
+        {
+            if (running_.exchange(true))
+            {
+                return;
+            }
+
+            realtime_ = true;
+            service_threads_.reserve(PRIORITY_LEVELS);
+            for (std::uint8_t level = 0; level < PRIORITY_LEVELS; level++)
+            {
+                service_threads_.emplace_back(&VirtualInterruptController::serviceLoop, this, level);
+            }
+        }
+
+        void VirtualInterruptController::stop()
+        {
+            if (!running_.exchange(false))
+            {
+                return;
+            }
+
+            signalAllLevels();
+            for (auto &thread : service_threads_)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+            service_threads_.clear();
+        }
+
+        void VirtualInterruptController::setCpu(int cpu)
+        {
+            // Applied by each service thread at its next wakeup
+            cpu_ = cpu;
+            cpu_generation_++;
+            signalAllLevels();
+        }
+
+        void VirtualInterruptController::setHandler(std::uint8_t irq, Handler handler)
+        {
+            checkIrq(irq);
+            lines_[irq].handler.store(handler ? std::make_shared<const Handler>(std::move(handler)) : nullptr);
+        }
+
+        void VirtualInterruptController::setPriority(std::uint8_t irq, std::uint8_t priority)
+        {
+            checkIrq(irq);
+            priority = std::min<std::uint8_t>(priority, PRIORITY_LEVELS - 1);
+            lines_[irq].priority = priority;
+
+            // A pending line moves to its new level's queue
+            if (isPending(irq))
+            {
+                signalLevel(priority);
+            }
+        }
+
+        std::uint8_t VirtualInterruptController::getPriority(std::uint8_t irq) const
+        {
+            checkIrq(irq);
+            return lines_[irq].priority;
+        }
+
+        void VirtualInterruptController::enable(std::uint8_t irq)
+        {
+            checkIrq(irq);
+            enabled_.fetch_or(std::uint32_t{1} << irq);
+            if (isPending(irq))
+            {
+                signalLevel(lines_[irq].priority);
+            }
+        }
+
+        void VirtualInterruptController::disable(std::uint8_t irq)
+        {
+            checkIrq(irq);
+            enabled_.fetch_and(~(std::uint32_t{1} << irq));
+        }
+
+        bool VirtualInterruptController::isEnabled(std::uint8_t irq) const
+        {
+            checkIrq(irq);
+            return (enabled_ & (std::uint32_t{1} << irq)) != 0;
+        }
+
+        void VirtualInterruptController::raise(std::uint8_t irq)
+        {
+            checkIrq(irq);
+            Line &line = lines_[irq];
+            std::uint32_t bit = std::uint32_t{1} << irq;
+            line.raised.fetch_add(1, std::memory_order_relaxed);
+
+            // Timestamp before publishing the pending bit, so the service
+            // thread never measures from an older raise
+            if (pending_.load(std::memory_order_relaxed) & bit)
+            {
+                line.coalesced.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            line.raise_time_ns.store(nowNs(), std::memory_order_relaxed);
+            if (pending_.fetch_or(bit) & bit)
+            {
+                line.coalesced.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            EDURTOS_TRACE(DRIVER, nvic, raise, irq);
+            signalLevel(line.priority);
+        }
+
+        void VirtualInterruptController::clearPending(std::uint8_t irq)
+        {
+            checkIrq(irq);
+            pending_.fetch_and(~(std::uint32_t{1} << irq));
+        }
+
+        bool VirtualInterruptController::isPending(std::uint8_t irq) const
+        {
+            checkIrq(irq);
+            return (pending_ & (std::uint32_t{1} << irq)) != 0;
+        }
+
+        void VirtualInterruptController::disableInterrupts()
+        {
+            disable_count_++;
+            if (in_interrupt_)
+            {
+                return;
+            }
+
+            // Handlers that got past the mask check before it was set
+            for (int active = active_handlers_; active > 0; active = active_handlers_)
+            {
+                active_handlers_.wait(active);
+            }
+        }
+
+        void VirtualInterruptController::enableInterrupts()
+        {
+            if (disable_count_.fetch_sub(1) == 1)
+            {
+                signalAllLevels();
+            }
+        }
+
+        void VirtualInterruptController::setPriorityThreshold(std::uint8_t threshold)
+        {
+            threshold_ = threshold;
+            signalAllLevels();
+        }
+
+        std::size_t VirtualInterruptController::getNestingDepth() const
+        {
+            return std::popcount(active_levels_.load());
+        }
+
+        InterruptLineStatistics VirtualInterruptController::getStatistics(std::uint8_t irq) const
+        {
+            checkIrq(irq);
+            const Line &line = lines_[irq];
+
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            InterruptLineStatistics statistics = line.statistics;
+            statistics.raised = line.raised;
+            statistics.coalesced = line.coalesced;
+            if (statistics.serviced > 0)
+            {
+                statistics.average_handler_time = line.total_handler_time / statistics.serviced;
+            }
+            return statistics;
+        }
+
+        void VirtualInterruptController::resetStatistics()
+        {
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            for (Line &line : lines_)
+            {
+                line.raised = 0;
+                line.coalesced = 0;
+                line.statistics = InterruptLineStatistics{};
+                line.total_handler_time = std::chrono::nanoseconds(0);
+            }
+            max_nesting_ = getNestingDepth();
+        }
+
+        void VirtualInterruptController::serviceLoop(std::uint8_t level)
+        {
+            std::uint32_t pinned_generation = cpu_generation_;
+            pinServiceThread();
+            if (!setCurrentThreadRealtime(level + 1))
+            {
+                realtime_ = false;
+            }
+
+            while (running_)
+            {
+                if (pinned_generation != cpu_generation_)
+                {
+                    pinned_generation = cpu_generation_;
+                    pinServiceThread();
+                }
+
+                std::uint32_t signal = level_signals_[level].load();
+                if (!serviceLevel(level) && running_)
+                {
+                    level_signals_[level].wait(signal);
+                }
+            }
+        }
+
+        void VirtualInterruptController::pinServiceThread()
+        {
+            int cpu = cpu_;
+            if (!pinCurrentThread(cpu))
+            {
+                std::cerr << "Failed to pin interrupt service thread to CPU " << cpu << std::endl;
+            }
+        }
+
+        bool VirtualInterruptController::serviceLevel(std::uint8_t level)
+        {
+            if (disable_count_ > 0 || level < threshold_)
+            {
+                return false;
+            }
+
+            // Lowest numbered pending, enabled line at this level
+            std::uint8_t irq = IRQ_COUNT;
+            for (std::uint32_t candidates = pending_ & enabled_; candidates != 0; candidates &= candidates - 1)
+            {
+                auto index = static_cast<std::uint8_t>(std::countr_zero(candidates));
+                if (lines_[index].priority == level)
+                {
+                    irq = index;
+                    break;
+                }
+            }
+            if (irq == IRQ_COUNT)
+            {
+                return false;
+            }
+
+            // Claim the line; another level may have taken it after a priority change
+            Line &line = lines_[irq];
+            std::uint32_t bit = std::uint32_t{1} << irq;
+            if (!(pending_.fetch_and(~bit) & bit))
+            {
+                return true;
+            }
+
+            // Pairs with disableInterrupts(): either it sees this handler
+            // active, or this sees the mask and puts the line back
+            active_handlers_++;
+            if (disable_count_ > 0)
+            {
+                pending_.fetch_or(bit);
+                if (--active_handlers_ == 0)
+                {
+                    active_handlers_.notify_all();
+                }
+                return false;
+            }
+
+            std::int64_t entry_ns = nowNs();
+            auto latency = std::chrono::nanoseconds(std::max<std::int64_t>(entry_ns - line.raise_time_ns.load(), 0));
+            std::uint32_t levels = active_levels_.fetch_or(std::uint32_t{1} << level) | (std::uint32_t{1} << level);
+            std::size_t depth = std::popcount(levels);
+            for (std::size_t max = max_nesting_; depth > max && !max_nesting_.compare_exchange_weak(max, depth);)
+            {
+            }
+
+            EDURTOS_TRACE(DRIVER, nvic, enter, irq, latency.count(), depth);
+            if (auto handler = line.handler.load())
+            {
+                in_interrupt_ = true;
+                (*handler)();
+                in_interrupt_ = false;
+            }
+            auto handler_time = std::chrono::nanoseconds(nowNs() - entry_ns);
+            EDURTOS_TRACE(DRIVER, nvic, exit, irq, handler_time.count());
+
+            active_levels_.fetch_and(~(std::uint32_t{1} << level));
+            if (--active_handlers_ == 0)
+            {
+                active_handlers_.notify_all();
+            }
+
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            InterruptLineStatistics &statistics = line.statistics;
+            statistics.latency.record(latency);
+            statistics.max_handler_time = std::max(statistics.max_handler_time, handler_time);
+            statistics.serviced++;
+            line.total_handler_time += handler_time;
+            return true;
+        }
+
+        void VirtualInterruptController::signalLevel(std::uint8_t level)
+        {
+            level_signals_[level].fetch_add(1);
+            level_signals_[level].notify_one();
+        }
+
+        void VirtualInterruptController::signalAllLevels()
+        {
+            for (std::uint8_t level = 0; level < PRIORITY_LEVELS; level++)
+            {
+                signalLevel(level);
+            }
+        }
+
+        void VirtualInterruptController::checkIrq(std::uint8_t irq)
+        {
+            if (irq >= IRQ_COUNT)
+            {
+                throw std::out_of_range("IRQ number out of range");
+            }
+        }
+
+    } // namespace drivers
+} // namespace edurtos
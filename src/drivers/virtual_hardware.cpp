@@ -1,8 +1,20 @@
 #include "../../include/drivers/virtual_hardware.hpp"
+#include "../../include/kernel/host_thread.hpp"
+#include "../../include/util/trace.hpp"
+#include <algorithm>
+#include <bit>
 #include <chrono>
 #include <stdexcept>
 #include <iostream>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
 namespace edurtos
 {
     namespace drivers
@@ -11,164 +23,1215 @@ namespace edurtos
         // VirtualGPIO Implementation
         VirtualGPIO::VirtualGPIO()
         {
-            // Initialize all pins to INPUT mode
-            for (auto &mode : pin_modes_)
+            // All pins start as LOW inputs, interrupts on both edges once registered
+            pin_modes_.fill(PinMode::INPUT);
+            edges_.fill(Edge::BOTH);
+        }
+
+        void VirtualGPIO::setPinMode(std::uint8_t pin, PinMode mode)
+        {
+            checkPin(pin);
+            pin_modes_[pin] = mode;
+
+            PinMask bit = PinMask{1} << pin;
+            if (mode == PinMode::OUTPUT)
+            {
+                output_mask_.fetch_or(bit);
+            }
+            else
+            {
+                output_mask_.fetch_and(~bit);
+            }
+            EDURTOS_TRACE(DRIVER, gpio, set_mode, pin, mode);
+        }
+
+        VirtualGPIO::PinMode VirtualGPIO::getPinMode(std::uint8_t pin) const
+        {
+            checkPin(pin);
+            return pin_modes_[pin];
+        }
+
+        void VirtualGPIO::writePin(std::uint8_t pin, bool value)
+        {
+            checkPin(pin);
+
+            PinMask bit = PinMask{1} << pin;
+            if (!(output_mask_.load(std::memory_order_relaxed) & bit))
             {
-                mode = PinMode::INPUT;
+                EDURTOS_TRACE(DRIVER, gpio, write_rejected, pin, value);
+                return;
             }
 
-            // Initialize all pins to LOW state
-            for (auto &state : pin_states_)
+            EDURTOS_TRACE(DRIVER, gpio, write, pin, value);
+            if (value)
+            {
+                setBits(bit);
+            }
+            else
             {
-                state = false;
+                clearBits(bit);
             }
         }
 
-        void VirtualGPIO::setPinMode(std::uint8_t pin, PinMode mode)
+        bool VirtualGPIO::readPin(std::uint8_t pin) const
         {
-            if (pin >= PIN_COUNT)
+            checkPin(pin);
+            return (readPort() >> pin) & 1;
+        }
+
+        void VirtualGPIO::writePort(PinMask value)
+        {
+            modifyPort(ALL_PINS, value);
+        }
+
+        void VirtualGPIO::setBits(PinMask mask)
+        {
+            mask &= output_mask_.load(std::memory_order_relaxed);
+            PinMask old_value = port_.fetch_or(mask, std::memory_order_acq_rel);
+            updateOutputs(old_value, old_value | mask);
+        }
+
+        void VirtualGPIO::clearBits(PinMask mask)
+        {
+            mask &= output_mask_.load(std::memory_order_relaxed);
+            PinMask old_value = port_.fetch_and(~mask, std::memory_order_acq_rel);
+            updateOutputs(old_value, old_value & ~mask);
+        }
+
+        void VirtualGPIO::toggleBits(PinMask mask)
+        {
+            mask &= output_mask_.load(std::memory_order_relaxed);
+            PinMask old_value = port_.fetch_xor(mask, std::memory_order_acq_rel);
+            updateOutputs(old_value, old_value ^ mask);
+        }
+
+        void VirtualGPIO::modifyPort(PinMask clear_mask, PinMask set_mask)
+        {
+            PinMask outputs = output_mask_.load(std::memory_order_relaxed);
+            clear_mask &= outputs;
+            set_mask &= outputs;
+
+            PinMask old_value = port_.load(std::memory_order_relaxed);
+            PinMask new_value;
+            do
             {
-                throw std::out_of_range("Pin number out of range");
+                new_value = (old_value & ~clear_mask) | set_mask;
+            } while (!port_.compare_exchange_weak(old_value, new_value, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed));
+            updateOutputs(old_value, new_value);
+        }
+
+        void VirtualGPIO::registerInterrupt(std::uint8_t pin, std::function<void()> handler)
+        {
+            checkPin(pin);
+            bool armed = static_cast<bool>(handler);
+            if (controller_)
+            {
+                controller_->setHandler(first_irq_ + pin, std::move(handler));
+                if (armed)
+                {
+                    controller_->enable(first_irq_ + pin);
+                }
+                else
+                {
+                    controller_->disable(first_irq_ + pin);
+                }
             }
-            pin_modes_[pin] = mode;
+            else
+            {
+                interrupt_handlers_[pin] = std::move(handler);
+            }
+
+            if (armed)
+            {
+                armInterrupt(pin);
+            }
+            else
+            {
+                rising_mask_.fetch_and(~(PinMask{1} << pin));
+                falling_mask_.fetch_and(~(PinMask{1} << pin));
+            }
+            EDURTOS_TRACE(DRIVER, gpio, register_interrupt, pin);
         }
 
-        void VirtualGPIO::writePin(std::uint8_t pin, bool value)
+        void VirtualGPIO::registerInterrupt(std::uint8_t pin, const TaskPtr &task,
+                                            NotifyAction action, std::uint32_t value)
         {
-            if (pin >= PIN_COUNT)
+            std::weak_ptr<Task> target = task;
+            registerInterrupt(pin, [target, action, value]()
+                              {
+                                  if (auto task = target.lock())
+                                  {
+                                      task->notify(value, action);
+                                  } });
+        }
+
+        void VirtualGPIO::setInterruptEdge(std::uint8_t pin, Edge edge)
+        {
+            checkPin(pin);
+            edges_[pin] = edge;
+
+            PinMask bit = PinMask{1} << pin;
+            if ((rising_mask_ | falling_mask_) & bit)
             {
-                throw std::out_of_range("Pin number out of range");
+                armInterrupt(pin);
+            }
+        }
+
+        void VirtualGPIO::setInputLevel(std::uint8_t pin, bool level)
+        {
+            checkPin(pin);
+            PinMask bit = PinMask{1} << pin;
+            setInputLevels(bit, level ? bit : 0);
+        }
+
+        void VirtualGPIO::setInputLevels(PinMask mask, PinMask levels)
+        {
+            PinMask inputs = mask & ~output_mask_.load(std::memory_order_relaxed) & ALL_PINS;
+            levels &= inputs;
+
+            PinMask old_value = port_.load(std::memory_order_relaxed);
+            PinMask new_value;
+            do
+            {
+                new_value = (old_value & ~inputs) | levels;
+            } while (!port_.compare_exchange_weak(old_value, new_value, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed));
+
+            if (old_value != new_value)
+            {
+                EDURTOS_TRACE(DRIVER, gpio, input_change, old_value ^ new_value, new_value);
+                dispatchEdges(old_value, new_value);
             }
+        }
+
+        void VirtualGPIO::attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq)
+        {
+            controller_ = controller;
+            first_irq_ = first_irq;
 
-            if (pin_modes_[pin] != PinMode::OUTPUT)
+            // Handlers registered so far move to the controller
+            for (std::uint8_t pin = 0; controller_ && pin < PIN_COUNT; pin++)
+            {
+                if (interrupt_handlers_[pin])
+                {
+                    controller_->setHandler(first_irq_ + pin, std::move(interrupt_handlers_[pin]));
+                    controller_->enable(first_irq_ + pin);
+                    interrupt_handlers_[pin] = nullptr;
+                }
+            }
+        }
+
+        void VirtualGPIO::updateOutputs(PinMask old_value, PinMask new_value)
+        {
+            if (old_value == new_value)
             {
-                std::cerr << "Warning: Writing to non-OUTPUT pin" << std::endl;
                 return;
             }
 
-            pin_states_[pin] = value;
-            std::cout << "GPIO Pin " << static_cast<int>(pin) << " set to "
-                      << (value ? "HIGH" : "LOW") << std::endl;
+            EDURTOS_TRACE(DRIVER, gpio, port_write, old_value ^ new_value, new_value);
+            if (console_echo_.load(std::memory_order_relaxed)) [[unlikely]]
+            {
+                for (PinMask changed = old_value ^ new_value; changed != 0; changed &= changed - 1)
+                {
+                    int pin = std::countr_zero(changed);
+                    std::cout << "GPIO Pin " << pin << " set to "
+                              << (((new_value >> pin) & 1) ? "HIGH" : "LOW") << std::endl;
+                }
+            }
+            dispatchEdges(old_value, new_value);
         }
 
-        bool VirtualGPIO::readPin(std::uint8_t pin) const
+        void VirtualGPIO::dispatchEdges(PinMask old_value, PinMask new_value)
         {
-            if (pin >= PIN_COUNT)
+            PinMask changed = old_value ^ new_value;
+            PinMask fired = (changed & new_value & rising_mask_.load(std::memory_order_relaxed)) |
+                            (changed & old_value & falling_mask_.load(std::memory_order_relaxed));
+
+            for (; fired != 0; fired &= fired - 1)
             {
-                throw std::out_of_range("Pin number out of range");
+                auto pin = static_cast<std::uint8_t>(std::countr_zero(fired));
+                if (controller_)
+                {
+                    controller_->raise(first_irq_ + pin);
+                }
+                else if (interrupt_handlers_[pin])
+                {
+                    interrupt_handlers_[pin]();
+                }
             }
-            return pin_states_[pin];
         }
 
-        void VirtualGPIO::registerInterrupt(std::uint8_t pin, std::function<void()> handler)
+        void VirtualGPIO::armInterrupt(std::uint8_t pin)
+        {
+            PinMask bit = PinMask{1} << pin;
+            if (edges_[pin] == Edge::FALLING)
+            {
+                rising_mask_.fetch_and(~bit);
+            }
+            else
+            {
+                rising_mask_.fetch_or(bit);
+            }
+            if (edges_[pin] == Edge::RISING)
+            {
+                falling_mask_.fetch_and(~bit);
+            }
+            else
+            {
+                falling_mask_.fetch_or(bit);
+            }
+        }
+
+        void VirtualGPIO::checkPin(std::uint8_t pin)
         {
             if (pin >= PIN_COUNT)
             {
                 throw std::out_of_range("Pin number out of range");
             }
-            interrupt_handlers_[pin] = std::move(handler);
         }
 
         // VirtualTimer Implementation
-        VirtualTimer::VirtualTimer() = default;
+        VirtualTimer::VirtualTimer(ClockSource clock)
+            : clock_(clock), epoch_(std::chrono::steady_clock::now())
+        {
+            if (clock_ == ClockSource::HOST)
+            {
+                startThread();
+            }
+        }
 
-        void VirtualTimer::start(std::uint32_t interval_ms, TimerMode mode)
+        VirtualTimer::~VirtualTimer()
         {
-            interval_ms_ = interval_ms;
-            mode_ = mode;
-            running_ = true;
-            last_trigger_time_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                     std::chrono::steady_clock::now().time_since_epoch())
-                                     .count();
+            if (!thread_.joinable())
+            {
+                return;
+            }
 
-            std::cout << "Virtual Timer started with interval " << interval_ms << "ms" << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                thread_running_ = false;
+                armHostTimer();
+            }
+            thread_.join();
+#ifdef __linux__
+            if (timer_fd_ >= 0)
+            {
+                ::close(timer_fd_);
+            }
+#endif
+        }
+
+        void VirtualTimer::start(std::uint32_t interval_ms, TimerMode mode)
+        {
+            startChannel(0, std::chrono::milliseconds(interval_ms), mode);
         }
 
         void VirtualTimer::stop()
         {
-            running_ = false;
-            std::cout << "Virtual Timer stopped" << std::endl;
+            stopChannel(0);
         }
 
         bool VirtualTimer::isRunning() const
         {
-            return running_;
+            return isChannelRunning(0);
         }
 
         void VirtualTimer::registerCallback(std::function<void()> callback)
         {
-            callback_ = std::move(callback);
+            setChannelCallback(0, std::move(callback));
+        }
+
+        void VirtualTimer::registerCallback(const TaskPtr &task, NotifyAction action, std::uint32_t value)
+        {
+            std::weak_ptr<Task> target = task;
+            registerCallback([target, action, value]()
+                             {
+                                 if (auto task = target.lock())
+                                 {
+                                     task->notify(value, action);
+                                 } });
+        }
+
+        void VirtualTimer::startChannel(std::size_t channel, std::chrono::nanoseconds interval, TimerMode mode)
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            Channel &entry = channels_[channel];
+            entry.mode = mode;
+            entry.running = true;
+            if (mode != TimerMode::INPUT_CAPTURE)
+            {
+                entry.compare = getCounter() + interval;
+                entry.reload = mode == TimerMode::PERIODIC ? interval : std::chrono::nanoseconds(0);
+                armHostTimer();
+            }
+            EDURTOS_TRACE(DRIVER, timer, start, channel, interval.count(), mode);
+        }
+
+        void VirtualTimer::stopChannel(std::size_t channel)
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            channels_[channel].running = false;
+            armHostTimer();
+            EDURTOS_TRACE(DRIVER, timer, stop, channel);
+        }
+
+        bool VirtualTimer::isChannelRunning(std::size_t channel) const
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return channels_[channel].running;
+        }
+
+        void VirtualTimer::setChannelCallback(std::size_t channel, std::function<void()> callback)
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            channels_[channel].callback = std::move(callback);
+            if (controller_)
+            {
+                controller_->setHandler(first_irq_ + channel, channels_[channel].callback);
+                controller_->enable(first_irq_ + channel);
+            }
+        }
+
+        void VirtualTimer::setCompare(std::size_t channel, std::chrono::nanoseconds counter_value)
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            channels_[channel].compare = counter_value;
+            armHostTimer();
+        }
+
+        std::chrono::nanoseconds VirtualTimer::getCompare(std::size_t channel) const
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return channels_[channel].compare;
+        }
+
+        void VirtualTimer::setAutoReload(std::size_t channel, std::chrono::nanoseconds period)
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            channels_[channel].reload = std::max(period, std::chrono::nanoseconds(0));
+        }
+
+        std::chrono::nanoseconds VirtualTimer::getAutoReload(std::size_t channel) const
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return channels_[channel].reload;
+        }
+
+        void VirtualTimer::capture(std::size_t channel)
+        {
+            checkChannel(channel);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Channel &entry = channels_[channel];
+                if (!entry.running || entry.mode != TimerMode::INPUT_CAPTURE)
+                {
+                    return;
+                }
+                entry.captured = getCounter();
+                entry.statistics.captures++;
+            }
+            EDURTOS_TRACE(DRIVER, timer, capture, channel);
+            dispatch(channel);
+        }
+
+        std::chrono::nanoseconds VirtualTimer::getCapture(std::size_t channel) const
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return channels_[channel].captured;
+        }
+
+        std::chrono::nanoseconds VirtualTimer::getCounter() const
+        {
+            if (clock_ == ClockSource::VIRTUAL)
+            {
+                return std::chrono::nanoseconds(virtual_now_ns_.load());
+            }
+            return std::chrono::steady_clock::now() - epoch_;
+        }
+
+        bool VirtualTimer::advance(std::chrono::nanoseconds duration)
+        {
+            if (clock_ != ClockSource::VIRTUAL)
+            {
+                return false;
+            }
+
+            // Stop at each expiry on the way, so callbacks see the counter
+            // at their exact compare value
+            std::int64_t target = virtual_now_ns_ + duration.count();
+            while (true)
+            {
+                std::int64_t next;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    next = nextExpiry().count();
+                }
+                if (next < 0 || next > target)
+                {
+                    break;
+                }
+                virtual_now_ns_ = std::max<std::int64_t>(virtual_now_ns_, next);
+                expire(getCounter());
+            }
+            virtual_now_ns_ = target;
+            return true;
+        }
+
+        TimerChannelStatistics VirtualTimer::getStatistics(std::size_t channel) const
+        {
+            checkChannel(channel);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return channels_[channel].statistics;
+        }
+
+        void VirtualTimer::resetStatistics()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (Channel &channel : channels_)
+            {
+                channel.statistics = TimerChannelStatistics{};
+            }
+        }
+
+        void VirtualTimer::attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            controller_ = controller;
+            first_irq_ = first_irq;
+            for (std::size_t channel = 0; controller_ && channel < CHANNEL_COUNT; channel++)
+            {
+                if (channels_[channel].callback)
+                {
+                    controller_->setHandler(first_irq_ + channel, channels_[channel].callback);
+                    controller_->enable(first_irq_ + channel);
+                }
+            }
         }
 
-        void VirtualTimer::update()
+        void VirtualTimer::startThread()
         {
-            if (!running_ || !callback_)
+#ifdef __linux__
+            timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+            if (timer_fd_ < 0)
+            {
+                std::cerr << "VirtualTimer: timerfd_create failed, using a condition variable" << std::endl;
+            }
+#endif
+            thread_running_ = true;
+            thread_ = std::thread(&VirtualTimer::threadLoop, this);
+        }
+
+        void VirtualTimer::threadLoop()
+        {
+            // The counter hardware is not delayed by interrupt handlers
+            setCurrentThreadRealtime(VirtualInterruptController::PRIORITY_LEVELS + 1);
+
+            while (thread_running_)
+            {
+                if (timer_fd_ >= 0)
+                {
+#ifdef __linux__
+                    std::uint64_t expirations;
+                    [[maybe_unused]] auto result = ::read(timer_fd_, &expirations, sizeof(expirations));
+#endif
+                }
+                else
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    auto next = nextExpiry();
+                    if (!thread_running_)
+                    {
+                        break;
+                    }
+                    if (next.count() < 0)
+                    {
+                        rearm_.wait(lock);
+                    }
+                    else
+                    {
+                        rearm_.wait_until(lock, epoch_ + next);
+                    }
+                }
+
+                if (thread_running_)
+                {
+                    expire(getCounter());
+                }
+            }
+        }
+
+        void VirtualTimer::armHostTimer()
+        {
+            if (clock_ != ClockSource::HOST)
             {
                 return;
             }
+            if (timer_fd_ < 0)
+            {
+                rearm_.notify_one();
+                return;
+            }
 
-            auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           std::chrono::steady_clock::now().time_since_epoch())
-                           .count();
+#ifdef __linux__
+            // steady_clock is CLOCK_MONOTONIC, so compare values convert
+            // directly to absolute expiry times. A stopping thread gets an
+            // expiry in the past; with nothing to do the timer is disarmed.
+            itimerspec spec{};
+            auto next = nextExpiry();
+            if (!thread_running_)
+            {
+                spec.it_value.tv_nsec = 1;
+            }
+            else if (next.count() >= 0)
+            {
+                auto when = std::chrono::duration_cast<std::chrono::nanoseconds>(epoch_.time_since_epoch() + next);
+                spec.it_value.tv_sec = static_cast<time_t>(when.count() / 1000000000);
+                spec.it_value.tv_nsec = static_cast<long>(when.count() % 1000000000);
+                if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+                {
+                    spec.it_value.tv_nsec = 1;
+                }
+            }
+            ::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+#endif
+        }
 
-            if (now - last_trigger_time_ >= interval_ms_)
+        std::chrono::nanoseconds VirtualTimer::nextExpiry() const
+        {
+            std::chrono::nanoseconds next(-1);
+            for (const Channel &channel : channels_)
             {
-                callback_();
-                last_trigger_time_ = now;
+                if (channel.running && channel.mode != TimerMode::INPUT_CAPTURE &&
+                    (next.count() < 0 || channel.compare < next))
+                {
+                    next = channel.compare;
+                }
+            }
+            return next;
+        }
 
-                // If one-shot timer, stop after triggering
-                if (mode_ == TimerMode::ONE_SHOT)
+        void VirtualTimer::expire(std::chrono::nanoseconds now)
+        {
+            std::uint32_t fired = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (std::size_t index = 0; index < CHANNEL_COUNT; index++)
                 {
-                    stop();
+                    Channel &channel = channels_[index];
+                    if (!channel.running || channel.mode == TimerMode::INPUT_CAPTURE || channel.compare > now)
+                    {
+                        continue;
+                    }
+
+                    channel.statistics.expiries++;
+                    channel.statistics.lateness.record(now - channel.compare);
+                    fired |= std::uint32_t{1} << index;
+
+                    // Reload from the ideal expiry; periods already over are missed
+                    if (channel.mode == TimerMode::PERIODIC && channel.reload.count() > 0)
+                    {
+                        auto periods = (now - channel.compare) / channel.reload;
+                        channel.statistics.missed += periods;
+                        channel.compare += (periods + 1) * channel.reload;
+                    }
+                    else
+                    {
+                        channel.running = false;
+                    }
                 }
+                armHostTimer();
+            }
+
+            for (; fired != 0; fired &= fired - 1)
+            {
+                auto channel = static_cast<std::size_t>(std::countr_zero(fired));
+                EDURTOS_TRACE(DRIVER, timer, fire, channel, now.count());
+                dispatch(channel);
+            }
+        }
+
+        void VirtualTimer::dispatch(std::size_t channel)
+        {
+            if (controller_)
+            {
+                controller_->raise(first_irq_ + channel);
+                return;
+            }
+
+            std::function<void()> callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                callback = channels_[channel].callback;
+            }
+            if (callback)
+            {
+                callback();
+            }
+        }
+
+        void VirtualTimer::checkChannel(std::size_t channel)
+        {
+            if (channel >= CHANNEL_COUNT)
+            {
+                throw std::out_of_range("Timer channel out of range");
             }
         }
 
         // VirtualUART Implementation
-        VirtualUART::VirtualUART() = default;
+        namespace
+        {
+            // Line thread period while there is traffic; characters are
+            // accounted in line time, so the tick only sets the granularity
+            constexpr std::chrono::milliseconds UART_LINE_TICK{1};
+        }
+
+        VirtualUART::VirtualUART()
+            : statistics_start_(std::chrono::steady_clock::now())
+        {
+            line_running_ = true;
+            line_thread_ = std::thread(&VirtualUART::lineLoop, this);
+        }
+
+        VirtualUART::~VirtualUART()
+        {
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                line_running_ = false;
+            }
+            line_wake_.notify_all();
+            tx_drained_.notify_all();
+            line_thread_.join();
+            closeHostBacking();
+        }
 
         void VirtualUART::configure(BaudRate baud_rate)
         {
             baud_rate_ = baud_rate;
-            std::cout << "UART configured with baud rate: ";
+            std::cout << "UART configured with baud rate: " << getBaudRate() << std::endl;
+        }
 
-            switch (baud_rate)
+        std::uint32_t VirtualUART::getBaudRate() const
+        {
+            switch (baud_rate_.load())
             {
             case BaudRate::BAUD_9600:
-                std::cout << "9600";
-                break;
+                return 9600;
             case BaudRate::BAUD_19200:
-                std::cout << "19200";
-                break;
+                return 19200;
             case BaudRate::BAUD_38400:
-                std::cout << "38400";
-                break;
+                return 38400;
             case BaudRate::BAUD_57600:
-                std::cout << "57600";
-                break;
+                return 57600;
             case BaudRate::BAUD_115200:
-                std::cout << "115200";
                 break;
             }
+            return 115200;
+        }
 
-            std::cout << std::endl;
+        std::chrono::nanoseconds VirtualUART::getCharacterTime() const
+        {
+            return std::chrono::nanoseconds(std::int64_t{BITS_PER_CHARACTER} * 1000000000 / getBaudRate());
         }
 
         void VirtualUART::transmit(const std::string &data)
         {
-            std::cout << "UART TX: " << data << std::endl;
+            EDURTOS_TRACE(DRIVER, uart, transmit, data.size());
+
+            std::size_t sent = 0;
+            while (sent < data.size())
+            {
+                std::size_t queued = write(data.data() + sent, data.size() - sent);
+                if (queued == 0)
+                {
+                    flush();
+                }
+                sent += queued;
+            }
+            flush();
         }
 
         std::string VirtualUART::receive()
         {
-            std::string data = receive_buffer_;
-            receive_buffer_.clear();
+            std::string data(rx_buffer_.bytesAvailable(), '\0');
+            data.resize(rx_buffer_.receive(data.data(), data.size()));
+            EDURTOS_TRACE(DRIVER, uart, receive, data.size());
             return data;
         }
 
         bool VirtualUART::hasData() const
         {
-            return !receive_buffer_.empty();
+            return !rx_buffer_.empty();
+        }
+
+        std::size_t VirtualUART::write(const void *data, std::size_t length)
+        {
+            std::size_t queued = tx_buffer_.send(data, length);
+            if (queued > 0)
+            {
+                // Taking the lock orders this against the line thread's idle check
+                {
+                    std::lock_guard<std::mutex> lock(line_mutex_);
+                }
+                line_wake_.notify_one();
+            }
+            return queued;
+        }
+
+        void VirtualUART::flush()
+        {
+            std::unique_lock<std::mutex> lock(line_mutex_);
+            tx_drained_.wait(lock, [this]()
+                             { return transmitIdle() || !line_running_; });
+        }
+
+        std::size_t VirtualUART::read(void *data, std::size_t max_length)
+        {
+            std::size_t length = rx_buffer_.receive(data, max_length);
+            EDURTOS_TRACE(DRIVER, uart, receive, length);
+            return length;
+        }
+
+        void VirtualUART::setReceiveNotify(const TaskPtr &task, std::size_t trigger_level)
+        {
+            rx_buffer_.setReader(task);
+            rx_buffer_.setTriggerLevel(trigger_level);
+        }
+
+        std::size_t VirtualUART::injectReceive(const void *data, std::size_t length)
+        {
+            std::uint32_t interrupts;
+            std::size_t overruns;
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                overruns = rx_overruns_;
+                interrupts = deliverReceive(static_cast<const std::byte *>(data), length);
+                overruns = rx_overruns_ - overruns;
+            }
+            raiseInterrupts(interrupts);
+            return length - overruns;
+        }
+
+        void VirtualUART::feedLine(const void *data, std::size_t length)
+        {
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                rx_wire_.append(static_cast<const char *>(data), length);
+            }
+            line_wake_.notify_one();
+        }
+
+        bool VirtualUART::transmitDma(const void *data, std::size_t length)
+        {
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                if (tx_dma_data_ || length == 0)
+                {
+                    return false;
+                }
+                tx_dma_data_ = static_cast<const std::byte *>(data);
+                tx_dma_remaining_ = length;
+            }
+            EDURTOS_TRACE(DRIVER, uart, transmit_dma, length);
+            line_wake_.notify_one();
+            return true;
+        }
+
+        bool VirtualUART::receiveDma(void *buffer, std::size_t length)
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            if (rx_dma_data_ || length == 0)
+            {
+                return false;
+            }
+            rx_dma_data_ = static_cast<std::byte *>(buffer);
+            rx_dma_length_ = length;
+            rx_dma_received_ = 0;
+            EDURTOS_TRACE(DRIVER, uart, receive_dma, length);
+            return true;
+        }
+
+        bool VirtualUART::isTransmitDmaBusy() const
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            return tx_dma_data_ != nullptr;
+        }
+
+        bool VirtualUART::isReceiveDmaBusy() const
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            return rx_dma_data_ != nullptr;
+        }
+
+        std::size_t VirtualUART::cancelReceiveDma()
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            std::size_t received = rx_dma_data_ ? rx_dma_received_ : 0;
+            rx_dma_data_ = nullptr;
+            return received;
+        }
+
+        std::string VirtualUART::openPseudoTerminal()
+        {
+#ifdef __linux__
+            closeHostBacking();
+
+            int master = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+            std::array<char, 128> name{};
+            if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0 ||
+                ::ptsname_r(master, name.data(), name.size()) != 0)
+            {
+                std::cerr << "UART: cannot create a pseudo-terminal" << std::endl;
+                if (master >= 0)
+                {
+                    ::close(master);
+                }
+                return "";
+            }
+
+            // Raw mode, so bytes pass unchanged in both directions
+            int slave = ::open(name.data(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+            termios settings{};
+            if (slave < 0 || ::tcgetattr(slave, &settings) != 0)
+            {
+                std::cerr << "UART: cannot open " << name.data() << std::endl;
+                ::close(master);
+                if (slave >= 0)
+                {
+                    ::close(slave);
+                }
+                return "";
+            }
+            ::cfmakeraw(&settings);
+            ::tcsetattr(slave, TCSANOW, &settings);
+            ::fcntl(master, F_SETFL, ::fcntl(master, F_GETFL) | O_NONBLOCK);
+
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                host_rx_fd_ = master;
+                host_tx_fd_ = master;
+                host_slave_fd_ = slave;
+            }
+            line_wake_.notify_one();
+            return name.data();
+#else
+            std::cerr << "UART: pseudo-terminals are not supported on this host" << std::endl;
+            return "";
+#endif
+        }
+
+        bool VirtualUART::openFiles(const std::string &rx_path, const std::string &tx_path)
+        {
+#ifdef __linux__
+            closeHostBacking();
+
+            int rx_fd = rx_path.empty() ? -1 : ::open(rx_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            int tx_fd = tx_path.empty() ? -1 : ::open(tx_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_NONBLOCK | O_CLOEXEC, 0644);
+            if ((!rx_path.empty() && rx_fd < 0) || (!tx_path.empty() && tx_fd < 0))
+            {
+                std::cerr << "UART: cannot open " << (rx_fd < 0 && !rx_path.empty() ? rx_path : tx_path) << std::endl;
+                if (rx_fd >= 0)
+                {
+                    ::close(rx_fd);
+                }
+                if (tx_fd >= 0)
+                {
+                    ::close(tx_fd);
+                }
+                return false;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                host_rx_fd_ = rx_fd;
+                host_tx_fd_ = tx_fd;
+            }
+            line_wake_.notify_one();
+            return true;
+#else
+            (void)rx_path;
+            (void)tx_path;
+            std::cerr << "UART: file backing is not supported on this host" << std::endl;
+            return false;
+#endif
+        }
+
+        void VirtualUART::closeHostBacking()
+        {
+            std::array<int, 3> fds;
+            {
+                std::lock_guard<std::mutex> lock(line_mutex_);
+                fds = {host_rx_fd_, host_tx_fd_ != host_rx_fd_ ? host_tx_fd_ : -1, host_slave_fd_};
+                host_rx_fd_ = -1;
+                host_tx_fd_ = -1;
+                host_slave_fd_ = -1;
+            }
+#ifdef __linux__
+            for (int fd : fds)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+            }
+#endif
+        }
+
+        void VirtualUART::registerReceiveInterrupt(std::function<void()> handler)
+        {
+            setInterrupt(RECEIVE, std::move(handler));
+        }
+
+        void VirtualUART::registerTransmitDmaInterrupt(std::function<void()> handler)
+        {
+            setInterrupt(TRANSMIT_DMA, std::move(handler));
+        }
+
+        void VirtualUART::registerReceiveDmaInterrupt(std::function<void()> handler)
+        {
+            setInterrupt(RECEIVE_DMA, std::move(handler));
+        }
+
+        void VirtualUART::attachInterruptController(VirtualInterruptController *controller, std::uint8_t first_irq)
+        {
+            controller_ = controller;
+            first_irq_ = first_irq;
+            for (std::uint8_t line = 0; controller_ && line < INTERRUPT_COUNT; line++)
+            {
+                if (handlers_[line])
+                {
+                    controller_->setHandler(first_irq_ + line, std::move(handlers_[line]));
+                    controller_->enable(first_irq_ + line);
+                    handlers_[line] = nullptr;
+                }
+            }
+        }
+
+        UartStatistics VirtualUART::getStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            UartStatistics statistics = statistics_;
+            statistics.rx_overruns = rx_overruns_;
+            statistics.tx_fifo_level = tx_buffer_.bytesAvailable();
+            statistics.rx_fifo_level = rx_buffer_.bytesAvailable();
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statistics_start_).count();
+            if (seconds > 0)
+            {
+                statistics.tx_bytes_per_second = statistics.tx_bytes / seconds;
+                statistics.rx_bytes_per_second = statistics.rx_bytes / seconds;
+            }
+            return statistics;
+        }
+
+        void VirtualUART::resetStatistics()
+        {
+            std::lock_guard<std::mutex> lock(line_mutex_);
+            statistics_ = UartStatistics{};
+            statistics_start_ = std::chrono::steady_clock::now();
+            rx_overruns_ = 0;
+        }
+
+        void VirtualUART::lineLoop()
+        {
+            std::unique_lock<std::mutex> lock(line_mutex_);
+            auto last = std::chrono::steady_clock::now();
+            while (line_running_)
+            {
+                bool busy = !tx_buffer_.empty() || tx_dma_data_ || !rx_wire_.empty() || host_rx_fd_ >= 0;
+                if (!busy)
+                {
+                    line_wake_.wait(lock);
+                    last = std::chrono::steady_clock::now();
+                    continue;
+                }
+
+                // Woken early by new work: the elapsed time is what counts
+                line_wake_.wait_until(lock, last + UART_LINE_TICK);
+                auto now = std::chrono::steady_clock::now();
+                std::uint32_t interrupts = shiftLine(now - last);
+                last = now;
+
+                bool drained = transmitIdle();
+                std::string echo;
+                if (drained)
+                {
+                    echo.swap(console_line_);
+                }
+
+                lock.unlock();
+                if (drained)
+                {
+                    tx_drained_.notify_all();
+                }
+                if (!echo.empty())
+                {
+                    std::cout << "UART TX: " << echo << std::endl;
+                    EDURTOS_TRACE(DRIVER, uart, flush, echo.size());
+                }
+                raiseInterrupts(interrupts);
+                lock.lock();
+            }
+        }
+
+        std::uint32_t VirtualUART::shiftLine(std::chrono::nanoseconds elapsed)
+        {
+            std::uint32_t interrupts = 0;
+            auto character = getCharacterTime();
+
+            // TX: queued bytes first, then the DMA buffer
+            statistics_.tx_fifo_peak = std::max(statistics_.tx_fifo_peak, tx_buffer_.bytesAvailable());
+            tx_credit_ += elapsed;
+            auto budget = static_cast<std::size_t>(tx_credit_ / character);
+            std::size_t sent = 0;
+            for (auto region = tx_buffer_.readRegion(); sent < budget && !region.empty(); region = tx_buffer_.readRegion())
+            {
+                std::size_t length = std::min(region.size(), budget - sent);
+                sendToWire(region.data(), length);
+                tx_buffer_.consume(length);
+                sent += length;
+            }
+            if (sent < budget && tx_dma_data_)
+            {
+                std::size_t length = std::min(tx_dma_remaining_, budget - sent);
+                sendToWire(tx_dma_data_, length);
+                tx_dma_data_ += length;
+                tx_dma_remaining_ -= length;
+                sent += length;
+                if (tx_dma_remaining_ == 0)
+                {
+                    tx_dma_data_ = nullptr;
+                    statistics_.tx_dma_transfers++;
+                    interrupts |= 1u << TRANSMIT_DMA;
+                }
+            }
+
+            // An idle line banks no time
+            tx_credit_ = sent < budget ? std::chrono::nanoseconds(0) : tx_credit_ - static_cast<std::int64_t>(sent) * character;
+
+            // RX: bytes fed to the wire first, then the host backing
+            rx_credit_ += elapsed;
+            budget = static_cast<std::size_t>(rx_credit_ / character);
+            std::size_t arrived = std::min(budget, rx_wire_.size());
+            if (arrived > 0)
+            {
+                interrupts |= deliverReceive(reinterpret_cast<const std::byte *>(rx_wire_.data()), arrived);
+                rx_wire_.erase(0, arrived);
+            }
+#ifdef __linux__
+            std::array<std::byte, 512> chunk;
+            while (arrived < budget && host_rx_fd_ >= 0)
+            {
+                ssize_t length = ::read(host_rx_fd_, chunk.data(), std::min(chunk.size(), budget - arrived));
+                if (length <= 0)
+                {
+                    break;
+                }
+                interrupts |= deliverReceive(chunk.data(), static_cast<std::size_t>(length));
+                arrived += static_cast<std::size_t>(length);
+            }
+#endif
+            rx_credit_ = arrived < budget ? std::chrono::nanoseconds(0) : rx_credit_ - static_cast<std::int64_t>(arrived) * character;
+            return interrupts;
+        }
+
+        void VirtualUART::sendToWire(const std::byte *data, std::size_t length)
+        {
+            statistics_.tx_bytes += length;
+#ifdef __linux__
+            if (host_tx_fd_ >= 0)
+            {
+                ssize_t written = ::write(host_tx_fd_, data, length);
+                statistics_.tx_dropped += length - static_cast<std::size_t>(std::max<ssize_t>(written, 0));
+            }
+#endif
+            if (console_echo_.load(std::memory_order_relaxed))
+            {
+                console_line_.append(reinterpret_cast<const char *>(data), length);
+            }
+        }
+
+        std::uint32_t VirtualUART::deliverReceive(const std::byte *data, std::size_t length)
+        {
+            if (length == 0)
+            {
+                return 0;
+            }
+
+            std::uint32_t interrupts = 0;
+            statistics_.rx_bytes += length;
+
+            // An armed receive DMA takes the bytes before the FIFO
+            if (rx_dma_data_)
+            {
+                std::size_t copied = std::min(length, rx_dma_length_ - rx_dma_received_);
+                std::copy_n(data, copied, rx_dma_data_ + rx_dma_received_);
+                rx_dma_received_ += copied;
+                data += copied;
+                length -= copied;
+                if (rx_dma_received_ == rx_dma_length_)
+                {
+                    rx_dma_data_ = nullptr;
+                    statistics_.rx_dma_transfers++;
+                    interrupts |= 1u << RECEIVE_DMA;
+                }
+            }
+
+            if (length > 0)
+            {
+                std::size_t accepted = rx_buffer_.send(data, length);
+                if (accepted < length)
+                {
+                    rx_overruns_ += length - accepted;
+                    EDURTOS_TRACE(DRIVER, uart, overrun, length - accepted);
+                }
+                statistics_.rx_fifo_peak = std::max(statistics_.rx_fifo_peak, rx_buffer_.bytesAvailable());
+                interrupts |= 1u << RECEIVE;
+            }
+            return interrupts;
+        }
+
+        bool VirtualUART::transmitIdle() const
+        {
+            return tx_buffer_.empty() && !tx_dma_data_;
+        }
+
+        void VirtualUART::raiseInterrupts(std::uint32_t interrupts)
+        {
+            for (; interrupts != 0; interrupts &= interrupts - 1)
+            {
+                auto line = static_cast<std::uint8_t>(std::countr_zero(interrupts));
+                if (controller_)
+                {
+                    controller_->raise(first_irq_ + line);
+                }
+                else if (handlers_[line])
+                {
+                    handlers_[line]();
+                }
+            }
+        }
+
+        void VirtualUART::setInterrupt(Interrupt line, std::function<void()> handler)
+        {
+            if (controller_)
+            {
+                controller_->setHandler(first_irq_ + line, std::move(handler));
+                controller_->enable(first_irq_ + line);
+            }
+            else
+            {
+                handlers_[line] = std::move(handler);
+            }
         }
 
         // HAL Implementation
@@ -178,7 +1241,24 @@ namespace edurtos
             return instance;
         }
 
-        HAL::HAL() = default;
+        HAL::HAL()
+        {
+            gpio_.attachInterruptController(&interrupt_controller_, IRQ_GPIO_BASE);
+            timer_.attachInterruptController(&interrupt_controller_, IRQ_TIMER);
+            uart_.attachInterruptController(&interrupt_controller_, IRQ_UART_RX);
+            interrupt_controller_.start();
+        }
+
+        HAL::~HAL()
+        {
+            // Handlers may use the devices
+            interrupt_controller_.stop();
+        }
+
+        VirtualInterruptController &HAL::getInterruptController()
+        {
+            return interrupt_controller_;
+        }
 
         VirtualGPIO &HAL::getGPIO()
         {
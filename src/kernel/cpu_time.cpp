@@ -0,0 +1,50 @@
+#include "../../include/kernel/cpu_time.hpp"
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace edurtos
+{
+    std::chrono::nanoseconds threadCpuTime()
+    {
+#ifdef _WIN32
+        FILETIME creation_time, exit_time, kernel_time, user_time;
+        if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+        {
+            return std::chrono::nanoseconds(0);
+        }
+
+        // FILETIME counts 100ns intervals
+        auto to_ticks = [](const FILETIME &ft)
+        {
+            return (static_cast<unsigned long long>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+        };
+        return std::chrono::nanoseconds((to_ticks(kernel_time) + to_ticks(user_time)) * 100);
+#else
+        timespec ts{};
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        {
+            return std::chrono::nanoseconds(0);
+        }
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#endif
+    }
+
+    void sleepUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        constexpr auto spin_margin = std::chrono::microseconds(200);
+        if (deadline - std::chrono::steady_clock::now() > spin_margin)
+        {
+            std::this_thread::sleep_until(deadline - spin_margin);
+        }
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+} // namespace edurtos
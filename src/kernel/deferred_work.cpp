@@ -0,0 +1,187 @@
+#include "../../include/kernel/deferred_work.hpp"
+#include "../../include/util/trace.hpp"
+#include <bit>
+#include <iostream>
+
+namespace edurtos
+{
+    namespace
+    {
+        std::int64_t nowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+    }
+
+    DeferredWorkQueue::DeferredWorkQueue(std::string name, std::uint8_t priority, std::size_t batch_size)
+        : name_(std::move(name)), batch_size_(std::max<std::size_t>(batch_size, 1))
+    {
+        task_ = std::make_shared<Task>(name_, [this]()
+                                       { drain(); }, priority);
+    }
+
+    int DeferredWorkQueue::addSource(const std::string &name, WorkFunction work)
+    {
+        if (source_count_ >= MAX_SOURCES)
+        {
+            std::cerr << "Deferred work queue " << name_ << " has no free source for " << name << std::endl;
+            return -1;
+        }
+
+        Source &source = sources_[source_count_];
+        source.name = name;
+        source.work = std::move(work);
+        source.statistics.name = name;
+        return static_cast<int>(source_count_++);
+    }
+
+    bool DeferredWorkQueue::raise(int source)
+    {
+        if (source < 0 || static_cast<std::size_t>(source) >= source_count_)
+        {
+            return false;
+        }
+
+        Source &entry = sources_[source];
+        entry.raised.fetch_add(1, std::memory_order_relaxed);
+
+        // The raise that makes the count non-zero stamps the run and, if no
+        // other source is pending either, wakes the bottom half
+        if (entry.count.fetch_add(1) == 0)
+        {
+            entry.first_raise_ns.store(nowNs(), std::memory_order_relaxed);
+            std::uint64_t bit = std::uint64_t{1} << source;
+            if (pending_.fetch_or(bit) == 0)
+            {
+                task_->notify(0, NotifyAction::NO_ACTION);
+            }
+        }
+        return true;
+    }
+
+    bool DeferredWorkQueue::start(Scheduler &scheduler)
+    {
+        if (scheduler_)
+        {
+            return false;
+        }
+        if (scheduler.findTask(name_))
+        {
+            std::cerr << "Deferred work queue " << name_ << ": scheduler already has a task with that name" << std::endl;
+            return false;
+        }
+
+        // A stopped queue's task was terminated by its scheduler
+        if (task_->getState() == TaskState::TERMINATED)
+        {
+            task_ = std::make_shared<Task>(name_, [this]()
+                                           { drain(); }, task_->getBasePriority());
+        }
+
+        scheduler_ = &scheduler;
+        scheduler.addTask(task_);
+        return true;
+    }
+
+    void DeferredWorkQueue::stop()
+    {
+        // drain() runs on this object; removeTask() waits for a running job
+        if (scheduler_ && scheduler_->findTask(name_) == task_)
+        {
+            scheduler_->removeTask(name_);
+        }
+        scheduler_ = nullptr;
+    }
+
+    void DeferredWorkQueue::drain()
+    {
+        // Consume the wakeup first; raises from here on set it again
+        std::uint32_t value;
+        if (task_->isNotificationPending())
+        {
+            task_->waitForNotification(value, 0);
+        }
+
+        std::uint64_t taken = pending_.exchange(0);
+
+        // Leave sources beyond the batch for the next job
+        std::uint64_t batch = 0;
+        for (std::size_t i = 0; i < batch_size_ && taken != 0; i++)
+        {
+            batch |= taken & (~taken + 1);
+            taken &= taken - 1;
+        }
+        if (taken != 0)
+        {
+            pending_.fetch_or(taken);
+        }
+
+        std::size_t batch_count = std::popcount(batch);
+        drains_.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t max = max_batch_; batch_count > max && !max_batch_.compare_exchange_weak(max, batch_count);)
+        {
+        }
+        EDURTOS_TRACE(SCHEDULER, deferred_work, drain, batch_count);
+
+        for (; batch != 0; batch &= batch - 1)
+        {
+            Source &source = sources_[std::countr_zero(batch)];
+
+            // Read the stamp before taking the count: a raise after the
+            // exchange starts a new run and restamps
+            std::int64_t first_raise_ns = source.first_raise_ns.load(std::memory_order_relaxed);
+            std::uint32_t count = source.count.exchange(0);
+            if (count == 0)
+            {
+                continue;
+            }
+
+            std::int64_t start_ns = nowNs();
+            source.work(count);
+            std::int64_t end_ns = nowNs();
+
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            source.statistics.runs++;
+            source.statistics.coalesced += count - 1;
+            source.statistics.latency.record(std::chrono::nanoseconds(end_ns - first_raise_ns));
+            source.statistics.max_run_time = std::max(source.statistics.max_run_time,
+                                                      std::chrono::nanoseconds(end_ns - start_ns));
+        }
+
+        // Nothing left: block until the next raise. A raise since the
+        // exchange left a notification pending, so the task stays ready.
+        if (pending_.load() == 0)
+        {
+            task_->waitForNotification(value, 0);
+        }
+    }
+
+    std::vector<DeferredWorkStatistics> DeferredWorkQueue::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        std::vector<DeferredWorkStatistics> statistics;
+        statistics.reserve(source_count_);
+        for (std::size_t i = 0; i < source_count_; i++)
+        {
+            statistics.push_back(sources_[i].statistics);
+            statistics.back().raised = sources_[i].raised;
+        }
+        return statistics;
+    }
+
+    void DeferredWorkQueue::resetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        for (std::size_t i = 0; i < source_count_; i++)
+        {
+            sources_[i].raised = 0;
+            sources_[i].statistics = DeferredWorkStatistics{};
+            sources_[i].statistics.name = sources_[i].name;
+        }
+        drains_ = 0;
+        max_batch_ = 0;
+    }
+
+} // namespace edurtos
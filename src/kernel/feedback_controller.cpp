@@ -0,0 +1,99 @@
+#include "../../include/kernel/feedback_controller.hpp"
+#include <algorithm>
+
+namespace edurtos
+{
+    FeedbackController::FeedbackController(FeedbackConfig config)
+        : config_(config)
+    {
+        rate_scale_ = std::clamp(1.0f, config_.min_rate_scale, config_.max_rate_scale);
+    }
+
+    void FeedbackController::setConfig(const FeedbackConfig &config)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+        rate_scale_ = std::clamp(rate_scale_, config_.min_rate_scale, config_.max_rate_scale);
+    }
+
+    FeedbackConfig FeedbackController::getConfig() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    void FeedbackController::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rate_scale_ = std::clamp(1.0f, config_.min_rate_scale, config_.max_rate_scale);
+        previous_utilization_error_ = 0.0f;
+        previous_miss_error_ = 0.0f;
+        history_.clear();
+    }
+
+    float FeedbackController::update(float utilization, float miss_ratio)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Errors are positive when there is headroom left
+        float utilization_error = (config_.target_utilization - utilization) / 100.0f;
+        float miss_error = config_.target_miss_ratio - miss_ratio;
+
+        // Velocity form: the integral term lives in rate_scale_ itself, so clamping
+        // the actuator is enough to prevent windup
+        float utilization_output = config_.utilization_kp * (utilization_error - previous_utilization_error_) +
+                                   config_.utilization_ki * utilization_error;
+        float miss_output = config_.miss_kp * (miss_error - previous_miss_error_) +
+                            config_.miss_ki * miss_error;
+
+        previous_utilization_error_ = utilization_error;
+        previous_miss_error_ = miss_error;
+
+        float delta = utilization_output;
+        if (miss_ratio > config_.target_miss_ratio)
+        {
+            delta = std::min(utilization_output, miss_output);
+        }
+
+        rate_scale_ = std::clamp(rate_scale_ + delta, config_.min_rate_scale, config_.max_rate_scale);
+
+        FeedbackSample sample;
+        sample.timestamp = std::chrono::steady_clock::now();
+        sample.measured_utilization = utilization;
+        sample.measured_miss_ratio = miss_ratio;
+        sample.utilization_output = utilization_output;
+        sample.miss_output = miss_output;
+        sample.rate_scale = rate_scale_;
+
+        history_.push_back(sample);
+        if (history_.size() > HISTORY_SIZE)
+        {
+            history_.pop_front();
+        }
+
+        return rate_scale_;
+    }
+
+    float FeedbackController::getRateScale() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rate_scale_;
+    }
+
+    FeedbackSample FeedbackController::getLastSample() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (history_.empty())
+        {
+            return FeedbackSample{};
+        }
+        return history_.back();
+    }
+
+    std::vector<FeedbackSample> FeedbackController::getHistory() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::vector<FeedbackSample>(history_.begin(), history_.end());
+    }
+
+} // namespace edurtos
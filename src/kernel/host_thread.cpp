@@ -0,0 +1,81 @@
+#include "../../include/kernel/host_thread.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace edurtos
+{
+    bool pinCurrentThread(int cpu)
+    {
+#if defined(_WIN32)
+        DWORD_PTR process_mask = 0, system_mask = 0;
+        if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8) ||
+            !GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        {
+            return false;
+        }
+        DWORD_PTR mask = cpu < 0 ? process_mask : (static_cast<DWORD_PTR>(1) << cpu);
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpu < 0)
+        {
+            long count = sysconf(_SC_NPROCESSORS_CONF);
+            for (long i = 0; i < count && i < CPU_SETSIZE; i++)
+            {
+                CPU_SET(i, &set);
+            }
+        }
+        else if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+        else
+        {
+            return false;
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    bool setCurrentThreadRealtime(int priority)
+    {
+        if (priority < 0 || priority > REALTIME_PRIORITY_MAX)
+        {
+            return false;
+        }
+
+#if defined(_WIN32)
+        // Outside the real-time class only three thread priorities sit above
+        // normal, so most levels would share one. In it, the relative
+        // priorities -7 to 6 are all distinct. Raising the whole process is
+        // left to the application.
+        if (GetPriorityClass(GetCurrentProcess()) != REALTIME_PRIORITY_CLASS)
+        {
+            return false;
+        }
+        return SetThreadPriority(GetCurrentThread(), -7 + priority) != 0;
+#elif defined(__linux__)
+        sched_param param{};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + priority;
+        if (param.sched_priority > sched_get_priority_max(SCHED_FIFO))
+        {
+            return false;
+        }
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+        return false;
+#endif
+    }
+
+} // namespace edurtos
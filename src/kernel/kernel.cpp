@@ -81,17 +81,21 @@ namespace edurtos
 
     void Kernel::removeTask(const std::string &name)
     {
-        std::lock_guard<std::mutex> lock(kernel_mutex_);
-
-        auto it = tasks_.find(name);
-        if (it == tasks_.end())
         {
-            std::cerr << "Task '" << name << "' not found\n";
-            return;
+            std::lock_guard<std::mutex> lock(kernel_mutex_);
+
+            auto it = tasks_.find(name);
+            if (it == tasks_.end())
+            {
+                std::cerr << "Task '" << name << "' not found\n";
+                return;
+            }
+            tasks_.erase(it);
         }
 
+        // Outside the kernel lock: this waits for a running job of the task,
+        // which may itself call into the kernel
         scheduler_->removeTask(name);
-        tasks_.erase(it);
 
         std::cout << "Removed task '" << name << "'\n";
     }
@@ -111,13 +115,18 @@ namespace edurtos
 
     void Kernel::suspendTask(const std::string &name)
     {
-        std::lock_guard<std::mutex> lock(kernel_mutex_);
-
+        // getTask() takes the kernel lock itself
         auto task = getTask(name);
         if (task)
         {
-            task->suspend();
-            std::cout << "Suspended task '" << name << "'\n";
+            if (task->suspend())
+            {
+                std::cout << "Suspended task '" << name << "'\n";
+            }
+            else
+            {
+                std::cerr << "Task '" << name << "' cannot be suspended\n";
+            }
         }
         else
         {
@@ -127,13 +136,18 @@ namespace edurtos
 
     void Kernel::resumeTask(const std::string &name)
     {
-        std::lock_guard<std::mutex> lock(kernel_mutex_);
-
+        // getTask() takes the kernel lock itself
         auto task = getTask(name);
         if (task)
         {
-            task->resume();
-            std::cout << "Resumed task '" << name << "'\n";
+            if (task->resume())
+            {
+                std::cout << "Resumed task '" << name << "'\n";
+            }
+            else
+            {
+                std::cerr << "Task '" << name << "' is not suspended\n";
+            }
         }
         else
         {
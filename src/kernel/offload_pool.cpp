@@ -0,0 +1,190 @@
+#include "../../include/kernel/offload_pool.hpp"
+#include "../../include/util/trace.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace edurtos
+{
+    OffloadPool::OffloadPool(std::string name, std::size_t max_concurrency, std::size_t max_queue_depth)
+        : name_(std::move(name)),
+          max_concurrency_(std::max<std::size_t>(max_concurrency, 1)),
+          max_queue_depth_(max_queue_depth)
+    {
+        workers_.reserve(max_concurrency_);
+        for (std::size_t i = 0; i < max_concurrency_; i++)
+        {
+            workers_.emplace_back(&OffloadPool::workerLoop, this, i);
+        }
+    }
+
+    OffloadPool::~OffloadPool()
+    {
+        stop();
+    }
+
+    void OffloadPool::stop()
+    {
+        std::deque<std::shared_ptr<OffloadCall>> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_.exchange(false))
+            {
+                return;
+            }
+            cancelled.swap(queue_);
+            statistics_.cancelled += cancelled.size();
+            statistics_.queue_depth = 0;
+        }
+        work_cv_.notify_all();
+
+        for (auto &call : cancelled)
+        {
+            finish(*call, OffloadCall::Status::CANCELLED);
+        }
+
+        for (auto &worker : workers_)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    bool OffloadPool::enqueue(const std::shared_ptr<OffloadCall> &call)
+    {
+        if (Task *task = Task::current())
+        {
+            call->waiter_ = task->weak_from_this();
+        }
+        call->submit_time_ = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            statistics_.submitted++;
+            if (!running_ || queue_.size() >= max_queue_depth_)
+            {
+                statistics_.rejected++;
+                call->status_.store(OffloadCall::Status::REJECTED, std::memory_order_release);
+                call->settled_.store(true, std::memory_order_release);
+                EDURTOS_TRACE(SCHEDULER, offload, reject, call.get(), queue_.size());
+                return false;
+            }
+
+            queue_.push_back(call);
+            statistics_.queue_depth = queue_.size();
+            statistics_.max_queue_depth = std::max(statistics_.max_queue_depth, queue_.size());
+        }
+
+        EDURTOS_TRACE(SCHEDULER, offload, submit, call.get());
+        work_cv_.notify_one();
+        return true;
+    }
+
+    void OffloadPool::workerLoop([[maybe_unused]] std::size_t index)
+    {
+        while (true)
+        {
+            std::shared_ptr<OffloadCall> call;
+            auto start_time = std::chrono::steady_clock::now();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [this]()
+                              { return !queue_.empty() || !running_; });
+                if (queue_.empty())
+                {
+                    return;
+                }
+
+                call = std::move(queue_.front());
+                queue_.pop_front();
+                statistics_.queue_depth = queue_.size();
+                statistics_.active++;
+
+                start_time = std::chrono::steady_clock::now();
+                auto queue_time = std::chrono::duration_cast<std::chrono::microseconds>(start_time - call->submit_time_);
+                total_queue_time_ += queue_time;
+                statistics_.max_queue_time = std::max(statistics_.max_queue_time, queue_time);
+            }
+
+            EDURTOS_TRACE(SCHEDULER, offload, call_begin, call.get(), index);
+            call->status_.store(OffloadCall::Status::RUNNING, std::memory_order_release);
+
+            auto status = OffloadCall::Status::COMPLETED;
+            try
+            {
+                call->invoke();
+            }
+            catch (...)
+            {
+                call->error_ = std::current_exception();
+                status = OffloadCall::Status::FAILED;
+            }
+
+            auto run_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                statistics_.active--;
+                if (status == OffloadCall::Status::COMPLETED)
+                {
+                    statistics_.completed++;
+                }
+                else
+                {
+                    statistics_.failed++;
+                }
+                total_run_time_ += run_time;
+                statistics_.max_run_time = std::max(statistics_.max_run_time, run_time);
+            }
+
+            EDURTOS_TRACE(SCHEDULER, offload, call_end, call.get(), run_time.count());
+            finish(*call, status);
+        }
+    }
+
+    void OffloadPool::finish(OffloadCall &call, OffloadCall::Status status)
+    {
+        // Publish the result before waking, so the waiter's next job sees it.
+        // The waiter only treats the call as done once settled_ is set, so it
+        // never consumes a pending notification before the wakeup was sent.
+        call.status_.store(status, std::memory_order_release);
+        if (auto task = call.waiter_.lock())
+        {
+            call.woke_waiter_ = true;
+            task->notify(0, NotifyAction::NO_ACTION);
+        }
+        call.settled_.store(true, std::memory_order_release);
+    }
+
+    OffloadPoolStatistics OffloadPool::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        OffloadPoolStatistics statistics = statistics_;
+
+        std::uint64_t started = statistics_.completed + statistics_.failed + statistics_.active;
+        if (started > 0)
+        {
+            statistics.average_queue_time = total_queue_time_ / started;
+        }
+        std::uint64_t finished = statistics_.completed + statistics_.failed;
+        if (finished > 0)
+        {
+            statistics.average_run_time = total_run_time_ / finished;
+        }
+        return statistics;
+    }
+
+    void OffloadPool::resetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        OffloadPoolStatistics statistics;
+        statistics.queue_depth = queue_.size();
+        statistics.max_queue_depth = queue_.size();
+        statistics.active = statistics_.active;
+        statistics_ = statistics;
+        total_queue_time_ = std::chrono::microseconds(0);
+        total_run_time_ = std::chrono::microseconds(0);
+    }
+
+} // namespace edurtos
@@ -0,0 +1,273 @@
+#include "../../include/kernel/partition_scheduler.hpp"
+#include "../../include/kernel/cpu_time.hpp"
+#include "../../include/util/trace.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace edurtos
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::chrono::microseconds toMicroseconds(Clock::duration duration)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+        }
+    } // namespace
+
+    PartitionScheduler::~PartitionScheduler()
+    {
+        stop();
+    }
+
+    Scheduler &PartitionScheduler::addPartition(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &partition : partitions_)
+        {
+            if (partition->name == name)
+            {
+                return *partition->scheduler;
+            }
+        }
+
+        auto partition = std::make_unique<Partition>();
+        partition->name = name;
+        partition->scheduler = std::make_unique<Scheduler>();
+        partitions_.push_back(std::move(partition));
+        return *partitions_.back()->scheduler;
+    }
+
+    Scheduler *PartitionScheduler::getPartition(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &partition : partitions_)
+        {
+            if (partition->name == name)
+            {
+                return partition->scheduler.get();
+            }
+        }
+        return nullptr;
+    }
+
+    bool PartitionScheduler::configure(const std::vector<PartitionWindowConfig> &table)
+    {
+        if (is_running_)
+        {
+            std::cerr << "Cannot change the partition schedule while it is running" << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Window> windows;
+        std::chrono::microseconds offset{0};
+
+        for (const auto &entry : table)
+        {
+            if (entry.duration.count() <= 0)
+            {
+                std::cerr << "Partition window has no length" << std::endl;
+                return false;
+            }
+
+            Window window;
+            if (!entry.partition.empty())
+            {
+                auto it = std::find_if(partitions_.begin(), partitions_.end(),
+                                       [&](const auto &partition)
+                                       { return partition->name == entry.partition; });
+                if (it == partitions_.end())
+                {
+                    std::cerr << "Unknown partition in schedule: " << entry.partition << std::endl;
+                    return false;
+                }
+                window.partition = it->get();
+            }
+
+            window.offset = offset;
+            window.duration = entry.duration;
+            window.statistics.partition = entry.partition;
+            window.statistics.offset = offset;
+            window.statistics.duration = entry.duration;
+            windows.push_back(std::move(window));
+            offset += entry.duration;
+        }
+
+        windows_ = std::move(windows);
+        major_frame_ = offset;
+        return true;
+    }
+
+    void PartitionScheduler::setIdleHook(IdleHook hook)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_hook_ = std::move(hook);
+    }
+
+    bool PartitionScheduler::start()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (windows_.empty())
+            {
+                std::cerr << "Partition schedule is empty" << std::endl;
+                return false;
+            }
+        }
+
+        if (is_running_.exchange(true))
+        {
+            return false;
+        }
+
+        frame_thread_ = std::thread(&PartitionScheduler::frameLoop, this);
+        return true;
+    }
+
+    void PartitionScheduler::stop()
+    {
+        if (is_running_.exchange(false) && frame_thread_.joinable())
+        {
+            frame_thread_.join();
+        }
+    }
+
+    std::chrono::microseconds PartitionScheduler::getMajorFrame() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return major_frame_;
+    }
+
+    std::vector<PartitionWindowStatistics> PartitionScheduler::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<PartitionWindowStatistics> statistics;
+        statistics.reserve(windows_.size());
+        for (const auto &window : windows_)
+        {
+            statistics.push_back(window.statistics);
+        }
+        return statistics;
+    }
+
+    void PartitionScheduler::resetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &window : windows_)
+        {
+            auto &statistics = window.statistics;
+            statistics = PartitionWindowStatistics{statistics.partition, statistics.offset, statistics.duration};
+            window.total_jitter_us = 0;
+        }
+        frames_ = 0;
+    }
+
+    void PartitionScheduler::frameLoop()
+    {
+        // The table is fixed while running; only statistics are shared
+        auto frame_start = Clock::now();
+
+        while (is_running_)
+        {
+            for (auto &window : windows_)
+            {
+                if (!is_running_)
+                {
+                    break;
+                }
+
+                auto start = frame_start + window.offset;
+                runWindow(window, start, start + window.duration);
+            }
+
+            frame_start += major_frame_;
+            frames_++;
+
+            // After a stall longer than a frame, resynchronize instead of
+            // replaying missed frames back to back
+            auto now = Clock::now();
+            if (now - frame_start > major_frame_)
+            {
+                EDURTOS_TRACE(SCHEDULER, partition, frame_resync, toMicroseconds(now - frame_start).count());
+                frame_start = now;
+            }
+        }
+    }
+
+    void PartitionScheduler::runWindow(Window &window, Clock::time_point start, Clock::time_point end)
+    {
+        // Unused time of the previous window ends at our planned start
+        sleepUntil(start);
+        auto actual_start = Clock::now();
+        auto jitter = toMicroseconds(actual_start - start);
+        [[maybe_unused]] auto index = static_cast<std::size_t>(&window - windows_.data());
+        EDURTOS_TRACE(SCHEDULER, partition, window_start, index, jitter.count());
+
+        IdleHook idle_hook;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_hook = idle_hook_;
+        }
+
+        std::size_t jobs = 0;
+        Clock::duration busy{0};
+        Clock::duration idle{0};
+        Clock::duration overrun{0};
+        const std::string &name = window.statistics.partition;
+
+        for (auto now = Clock::now(); now < end && is_running_; now = Clock::now())
+        {
+            if (window.partition)
+            {
+                jobs += window.partition->scheduler->runUntil(end);
+                auto after_jobs = Clock::now();
+                busy += after_jobs - now;
+                now = after_jobs;
+                if (now >= end)
+                {
+                    // A job ran longer than its WCET estimate
+                    overrun = now - end;
+                    break;
+                }
+            }
+
+            // Nothing (more) fits: hand the rest of the window to the idle hook,
+            // or wait for a task of this partition to become ready
+            if (idle_hook)
+            {
+                idle_hook(name, end);
+            }
+            else if (window.partition)
+            {
+                window.partition->scheduler->waitForWakeup(end);
+            }
+            else
+            {
+                // Idle window: the next window's start does the waiting
+                idle += end - now;
+                break;
+            }
+            idle += Clock::now() - now;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &statistics = window.statistics;
+        statistics.activations++;
+        statistics.jobs += jobs;
+        window.total_jitter_us += jitter.count();
+        statistics.average_jitter = std::chrono::microseconds(window.total_jitter_us / static_cast<std::int64_t>(statistics.activations));
+        statistics.max_jitter = std::max(statistics.max_jitter, jitter);
+        statistics.busy_time += toMicroseconds(busy);
+        statistics.idle_time += toMicroseconds(idle);
+
+        if (overrun.count() > 0)
+        {
+            statistics.overruns++;
+            statistics.max_overrun = std::max(statistics.max_overrun, toMicroseconds(overrun));
+            EDURTOS_TRACE(SCHEDULER, partition, window_overrun, index, toMicroseconds(overrun).count());
+        }
+    }
+
+} // namespace edurtos
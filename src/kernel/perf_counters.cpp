@@ -0,0 +1,191 @@
+#include "../../include/kernel/perf_counters.hpp"
+#include <algorithm>
+#include <iterator>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace edurtos
+{
+    PerfCounterValues &PerfCounterValues::operator+=(const PerfCounterValues &other)
+    {
+        instructions += other.instructions;
+        cycles += other.cycles;
+        cache_misses += other.cache_misses;
+        branch_misses += other.branch_misses;
+        task_clock_ns += other.task_clock_ns;
+        context_switches += other.context_switches;
+        page_faults += other.page_faults;
+        return *this;
+    }
+
+    PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues &other) const
+    {
+        PerfCounterValues result;
+        result.instructions = instructions - other.instructions;
+        result.cycles = cycles - other.cycles;
+        result.cache_misses = cache_misses - other.cache_misses;
+        result.branch_misses = branch_misses - other.branch_misses;
+        result.task_clock_ns = task_clock_ns - other.task_clock_ns;
+        result.context_switches = context_switches - other.context_switches;
+        result.page_faults = page_faults - other.page_faults;
+        return result;
+    }
+
+    PerfCounterGroup::~PerfCounterGroup()
+    {
+        close();
+    }
+
+    bool PerfCounterGroup::open()
+    {
+        if (isOpen())
+        {
+            return true;
+        }
+
+        // Prefer hardware events, fall back to software events (e.g. in VMs or
+        // when perf_event_paranoid hides the PMU)
+        if (openGroup(true))
+        {
+            mode_ = PerfCounterMode::HARDWARE;
+            return true;
+        }
+        if (openGroup(false))
+        {
+            mode_ = PerfCounterMode::SOFTWARE;
+            return true;
+        }
+
+        mode_ = PerfCounterMode::UNAVAILABLE;
+        return false;
+    }
+
+#ifdef __linux__
+    namespace
+    {
+        int perfEventOpen(std::uint32_t type, std::uint64_t config, int group_fd)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = group_fd < 0 ? 1 : 0; // Leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            // Calling thread, any CPU
+            return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+        }
+    }
+
+    bool PerfCounterGroup::openGroup(bool hardware)
+    {
+        struct Event
+        {
+            std::uint32_t type;
+            std::uint64_t config;
+            std::uint64_t PerfCounterValues::*field;
+        };
+
+        static const Event hardware_events[] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &PerfCounterValues::cycles},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &PerfCounterValues::instructions},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, &PerfCounterValues::cache_misses},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, &PerfCounterValues::branch_misses},
+        };
+        static const Event software_events[] = {
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, &PerfCounterValues::task_clock_ns},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, &PerfCounterValues::context_switches},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, &PerfCounterValues::page_faults},
+        };
+
+        const Event *events = hardware ? hardware_events : software_events;
+        std::size_t event_count = hardware ? std::size(hardware_events) : std::size(software_events);
+
+        for (std::size_t i = 0; i < event_count; i++)
+        {
+            int fd = perfEventOpen(events[i].type, events[i].config, leader_fd_);
+            if (fd < 0)
+            {
+                // Without a leader there is no group; missing members are skipped
+                if (i == 0)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            if (leader_fd_ < 0)
+            {
+                leader_fd_ = fd;
+            }
+            fds_.push_back(fd);
+            fields_.push_back(events[i].field);
+        }
+
+        ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+    }
+
+    void PerfCounterGroup::close()
+    {
+        for (int fd : fds_)
+        {
+            ::close(fd);
+        }
+        fds_.clear();
+        fields_.clear();
+        leader_fd_ = -1;
+        mode_ = PerfCounterMode::UNAVAILABLE;
+    }
+
+    PerfCounterValues PerfCounterGroup::read() const
+    {
+        PerfCounterValues values;
+        if (!isOpen())
+        {
+            return values;
+        }
+
+        // PERF_FORMAT_GROUP layout: { nr, value[nr] }
+        std::uint64_t buffer[1 + 8] = {};
+        if (::read(leader_fd_, buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(std::uint64_t)))
+        {
+            return values;
+        }
+
+        std::size_t count = std::min<std::size_t>(buffer[0], fields_.size());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values.*fields_[i] = buffer[1 + i];
+        }
+        return values;
+    }
+#else
+    bool PerfCounterGroup::openGroup(bool)
+    {
+        // perf_event_open is Linux-only
+        return false;
+    }
+
+    void PerfCounterGroup::close()
+    {
+        mode_ = PerfCounterMode::UNAVAILABLE;
+    }
+
+    PerfCounterValues PerfCounterGroup::read() const
+    {
+        return PerfCounterValues{};
+    }
+#endif
+
+} // namespace edurtos
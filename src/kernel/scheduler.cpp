@@ -1,29 +1,57 @@
 #include "../../include/kernel/scheduler.hpp"
+#include "../../include/kernel/cpu_time.hpp"
+#include "../../include/kernel/host_thread.hpp"
+#include "../../include/util/trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 namespace edurtos
 {
-    Scheduler::Scheduler(std::chrono::milliseconds time_slice)
+    template <typename Queue, typename Preemption, typename Lock>
+    BasicScheduler<Queue, Preemption, Lock>::BasicScheduler(std::chrono::milliseconds time_slice)
         : time_slice_(time_slice)
     {
         idle_start_time_ = std::chrono::steady_clock::now();
+        last_control_time_ = idle_start_time_;
+        release_epoch_ = idle_start_time_;
     }
 
-    Scheduler::~Scheduler()
+    template <typename Queue, typename Preemption, typename Lock>
+    BasicScheduler<Queue, Preemption, Lock>::~BasicScheduler()
     {
         stop();
+
+        {
+            std::lock_guard<std::mutex> lock(wake_sources_mutex_);
+            for (WakeSource *source : wake_sources_)
+            {
+                source->scheduler_ = nullptr;
+            }
+            wake_sources_.clear();
+        }
+
+        // Tasks may outlive the scheduler and its event bus
+        for (const auto &task : all_tasks_)
+        {
+            task->setStateListener(nullptr);
+            task->setEventBus(nullptr);
+        }
     }
 
-    void Scheduler::addTask(TaskPtr task)
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::addTask(TaskPtr task)
     {
-        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
         all_tasks_.push_back(task);
+        task->setEventBus(&event_bus_);
+        task->setStateListener(this);
+        addToReleaseGroup(*task);
 
         if (task->getState() == TaskState::READY)
         {
-            ready_queue_.push(task);
+            ready_queue_.push(*task);
         }
 
         // Assign a symbol for visualization
@@ -38,9 +66,10 @@ namespace edurtos
         }
     }
 
-    void Scheduler::removeTask(const std::string &name)
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::removeTask(const std::string &name)
     {
-        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        std::unique_lock<mutex_type> lock(scheduler_mutex_);
 
         // Find and remove the task
         auto it = std::find_if(all_tasks_.begin(), all_tasks_.end(),
@@ -51,6 +80,12 @@ namespace edurtos
         {
             TaskPtr task = *it;
             task->terminate();
+            task->setStateListener(nullptr);
+            task->setEventBus(nullptr);
+
+            // The queue only borrows the task; unlink it before the last owner goes
+            ready_queue_.remove(*task);
+            removeFromReleaseGroup(*task);
 
             // Remove from all_tasks_
             all_tasks_.erase(it);
@@ -58,14 +93,36 @@ namespace edurtos
             // Task symbols cleanup
             task_symbols_.erase(task);
 
-            // Note: We don't remove from ready_queue_ here, but it will be filtered out
-            // in selectNextTask() when its state is checked
+            // The dispatcher still uses a task whose job is running. Keep it
+            // alive until the job returns, and wait for that unless the job
+            // is removing its own task, so the caller may free whatever the
+            // handler uses.
+            if (running_job_ == task.get())
+            {
+                retired_tasks_.push_back(task);
+                if (job_thread_ != std::this_thread::get_id())
+                {
+                    job_done_cv_.wait(lock, [this, &task]()
+                                      { return running_job_ != task.get(); });
+                }
+            }
         }
     }
 
-    TaskPtr Scheduler::findTask(const std::string &name)
+    template <typename Queue, typename Preemption, typename Lock>
+    TaskPtr BasicScheduler<Queue, Preemption, Lock>::getCurrentTask() const
+    {
+        // Hand out an owning reference; the dispatcher itself only borrows.
+        // The lock keeps a removed task from being released meanwhile.
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
+        Task *task = current_task_.load(std::memory_order_acquire);
+        return task ? task->weak_from_this().lock() : nullptr;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    TaskPtr BasicScheduler<Queue, Preemption, Lock>::findTask(const std::string &name)
     {
-        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
 
         auto it = std::find_if(all_tasks_.begin(), all_tasks_.end(),
                                [&](const TaskPtr &task)
@@ -79,17 +136,20 @@ namespace edurtos
         return nullptr;
     }
 
-    void Scheduler::start()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::start()
+        requires(!std::is_same_v<Lock, NoLock>)
     {
         if (!is_running_.exchange(true))
         {
             last_schedule_time_ = std::chrono::steady_clock::now();
-            scheduler_thread_ = std::thread(&Scheduler::schedulerLoop, this);
-            deadline_monitor_thread_ = std::thread(&Scheduler::deadlineMonitorLoop, this);
+            scheduler_thread_ = std::thread(&BasicScheduler::schedulerLoop, this);
+            deadline_monitor_thread_ = std::thread(&BasicScheduler::deadlineMonitorLoop, this);
         }
     }
 
-    void Scheduler::stop()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::stop()
     {
         if (is_running_.exchange(false))
         {
@@ -105,113 +165,424 @@ namespace edurtos
         }
     }
 
-    void Scheduler::yield()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::setCpuAffinity(int cpu)
+    {
+        // Applied by the dispatcher thread itself at its next iteration
+        cpu_affinity_ = cpu;
+        affinity_changed_ = true;
+        scheduler_cv_.notify_one();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::addWakeSource(WakeSource &source)
+    {
+        std::lock_guard<std::mutex> lock(wake_sources_mutex_);
+        if (source.scheduler_.load() == this)
+        {
+            return;
+        }
+        if (source.scheduler_.load() != nullptr)
+        {
+            std::cerr << "Wake source is already attached to another scheduler" << std::endl;
+            return;
+        }
+
+        wake_sources_.push_back(&source);
+        source.scheduler_ = this;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::removeWakeSource(WakeSource &source)
+    {
+        // Taking the lock also waits out a processWakeups() in progress
+        std::lock_guard<std::mutex> lock(wake_sources_mutex_);
+        auto it = std::find(wake_sources_.begin(), wake_sources_.end(), &source);
+        if (it != wake_sources_.end())
+        {
+            wake_sources_.erase(it);
+            source.scheduler_ = nullptr;
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::signalWakeSources()
+    {
+        wake_sources_pending_ = true;
+        wakeup_pending_ = true;
+        scheduler_cv_.notify_one();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::processWakeSources()
+    {
+        std::lock_guard<std::mutex> lock(wake_sources_mutex_);
+        for (WakeSource *source : wake_sources_)
+        {
+            // Clear first so a request racing with processing is kept for the next pass
+            if (source->wake_requested_.exchange(false))
+            {
+                source->processWakeups();
+            }
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::yield()
     {
         // Cooperative yielding - a task voluntarily gives up the CPU
         force_reschedule_ = true;
         scheduler_cv_.notify_one();
     }
 
-    void Scheduler::setPreemptionMode(PreemptionMode mode)
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::setPreemptionMode(PreemptionMode mode)
     {
         preemption_mode_ = mode;
     }
 
-    void Scheduler::setTimeSlice(std::chrono::milliseconds time_slice)
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::setTimeSlice(std::chrono::milliseconds time_slice)
     {
         time_slice_ = time_slice;
     }
 
-    void Scheduler::adjustPriorities()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::adjustPriorities()
     {
-        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
 
         for (auto &task : all_tasks_)
         {
             task->updatePriority();
         }
 
-        // Rebuild ready queue with updated priorities
-        std::priority_queue<TaskPtr, std::vector<TaskPtr>, TaskPriorityCompare> new_queue;
-
-        while (!ready_queue_.empty())
+        // Requeue waiting tasks at their updated priorities
+        std::vector<Task *> waiting;
+        while (Task *task = ready_queue_.pop())
         {
-            auto task = ready_queue_.top();
-            ready_queue_.pop();
+            waiting.push_back(task);
+        }
 
+        for (Task *task : waiting)
+        {
             if (task->getState() == TaskState::READY)
             {
-                new_queue.push(task);
+                ready_queue_.push(*task);
+            }
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::enableFeedbackControl(bool enable)
+    {
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
+
+        if (feedback_enabled_.exchange(enable) == enable)
+        {
+            return;
+        }
+
+        // Start from nominal rates in both directions
+        feedback_controller_.reset();
+        float scale = enable ? feedback_controller_.getRateScale() : 1.0f;
+        for (auto &task : all_tasks_)
+        {
+            task->setRateScale(scale);
+        }
+
+        resetControlWindow();
+        restartReleaseGroups(std::chrono::steady_clock::now());
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::resetControlWindow()
+    {
+        last_control_time_ = std::chrono::steady_clock::now();
+        control_run_time_ = total_run_time_;
+        control_idle_time_ = total_idle_time_;
+        control_jobs_ = 0;
+        control_misses_ = 0;
+
+        for (const auto &task : all_tasks_)
+        {
+            control_jobs_ += task->getStatistics().execution_count;
+            control_misses_ += task->getStatistics().deadline_misses;
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::runFeedbackControl()
+    {
+        // Sample utilization over the last control period
+        auto run_time = total_run_time_ - control_run_time_;
+        auto idle_time = total_idle_time_ - control_idle_time_;
+        auto window = run_time + idle_time;
+
+        float utilization = 0.0f;
+        if (window.count() > 0)
+        {
+            utilization = static_cast<float>(run_time.count()) / window.count() * 100.0f;
+        }
+
+        // Sample the miss ratio over the same window
+        std::size_t jobs = 0;
+        std::size_t misses = 0;
+        for (const auto &task : all_tasks_)
+        {
+            jobs += task->getStatistics().execution_count;
+            misses += task->getStatistics().deadline_misses;
+        }
+
+        // Counters can go backwards when tasks are removed or statistics reset
+        std::size_t window_jobs = jobs > control_jobs_ ? jobs - control_jobs_ : 0;
+        std::size_t window_misses = misses > control_misses_ ? misses - control_misses_ : 0;
+
+        float miss_ratio = 0.0f;
+        if (window_misses > 0)
+        {
+            miss_ratio = std::min(1.0f, static_cast<float>(window_misses) / std::max<std::size_t>(window_jobs, 1));
+        }
+
+        float scale = feedback_controller_.update(utilization, miss_ratio);
+        EDURTOS_TRACE(SCHEDULER, scheduler, feedback_control, utilization, miss_ratio, scale);
+        for (auto &task : all_tasks_)
+        {
+            task->setRateScale(scale);
+        }
+
+        resetControlWindow();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::isReleased(const Task &task, std::chrono::steady_clock::time_point now) const
+    {
+        // Outside feedback mode tasks run back-to-back as before
+        if (!feedback_enabled_ || task.getPeriod().count() == 0)
+        {
+            return true;
+        }
+
+        // Runnable once per release of its group. Only called with the
+        // scheduler lock held, which guards the groups.
+        const ReleaseGroup *group = findReleaseGroup(task.getPeriod());
+        if (!group)
+        {
+            return true;
+        }
+
+        return now >= group->last_release && task.getStatistics().last_execution < group->last_release;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::addToReleaseGroup(Task &task)
+    {
+        if (task.getPeriod().count() == 0)
+        {
+            return;
+        }
+
+        auto it = std::lower_bound(release_groups_.begin(), release_groups_.end(), task.getPeriod(),
+                                   [](const ReleaseGroup &group, std::chrono::milliseconds period)
+                                   { return group.period < period; });
+        if (it == release_groups_.end() || it->period != task.getPeriod())
+        {
+            // Phase the new group on the common epoch, so it releases together
+            // with the groups whose periods it divides or is a multiple of
+            auto now = std::chrono::steady_clock::now();
+            auto period = std::max(task.getEffectivePeriod(), std::chrono::milliseconds(1));
+            ReleaseGroup group{task.getPeriod(), release_epoch_, release_epoch_, {}};
+            group.last_release += (now - release_epoch_) / period * period;
+            group.next_release = group.last_release + period;
+            next_group_release_ = std::min(next_group_release_, group.next_release);
+            it = release_groups_.insert(it, std::move(group));
+        }
+        it->members.push_back(&task);
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::removeFromReleaseGroup(Task &task)
+    {
+        for (auto group = release_groups_.begin(); group != release_groups_.end(); ++group)
+        {
+            auto member = std::find(group->members.begin(), group->members.end(), &task);
+            if (member != group->members.end())
+            {
+                group->members.erase(member);
+                if (group->members.empty())
+                {
+                    release_groups_.erase(group);
+                }
+                return;
             }
         }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    auto BasicScheduler<Queue, Preemption, Lock>::findReleaseGroup(std::chrono::milliseconds period) const
+        -> const ReleaseGroup *
+    {
+        auto it = std::lower_bound(release_groups_.begin(), release_groups_.end(), period,
+                                   [](const ReleaseGroup &group, std::chrono::milliseconds value)
+                                   { return group.period < value; });
+        return it != release_groups_.end() && it->period == period ? &*it : nullptr;
+    }
 
-        ready_queue_ = std::move(new_queue);
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::restartReleaseGroups(std::chrono::steady_clock::time_point now)
+    {
+        // Every group releases at `now`, then at multiples of its period
+        release_epoch_ = now;
+        next_group_release_ = std::chrono::steady_clock::time_point::max();
+        for (ReleaseGroup &group : release_groups_)
+        {
+            group.last_release = now;
+            group.next_release = now + std::max(group.members.front()->getEffectivePeriod(), std::chrono::milliseconds(1));
+            next_group_release_ = std::min(next_group_release_, group.next_release);
+        }
     }
 
-    void Scheduler::updateCpuUtilization()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::releaseDueGroups(std::chrono::steady_clock::time_point now)
     {
+        // One comparison per loop iteration until the earliest group is due
+        if (!feedback_enabled_ || now < next_group_release_)
+        {
+            return;
+        }
+
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (ReleaseGroup &group : release_groups_)
+        {
+            if (group.next_release <= now)
+            {
+                // Members share the rate scale, so any of them gives the group period
+                auto period = std::max(group.members.front()->getEffectivePeriod(), std::chrono::milliseconds(1));
+
+                for (Task *task : group.members)
+                {
+                    // A job left over from the previous release that is past its
+                    // deadline is a miss; it is counted once, here
+                    if (task->getDeadline().count() > 0 &&
+                        task->getState() != TaskState::BLOCKED &&
+                        task->getStatistics().last_execution < group.last_release &&
+                        group.last_release + task->getEffectiveDeadline() <= now)
+                    {
+                        task->recordDeadlineMiss();
+                    }
+
+                    if (task->getState() == TaskState::READY)
+                    {
+                        release_batch_.push_back(task);
+                    }
+                }
+
+                // Skip instants that passed while a long job ran
+                group.last_release = group.next_release + (now - group.next_release) / period * period;
+                group.next_release = group.last_release + period;
+            }
+            next = std::min(next, group.next_release);
+        }
+        next_group_release_ = next;
+
+        if (!release_batch_.empty())
+        {
+            EDURTOS_TRACE(SCHEDULER, scheduler, batch_release, release_batch_.size());
+            ready_queue_.pushBatch(release_batch_);
+            release_batch_.clear();
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::updateCpuUtilization()
+    {
+        // Utilization counts CPU time actually consumed by jobs, occupancy counts
+        // the wall-clock time the dispatcher spent inside them (including sleeps)
         auto total_time = total_run_time_ + total_idle_time_;
         if (total_time.count() > 0)
         {
-            cpu_utilization_ = static_cast<float>(total_run_time_.count()) / total_time.count() * 100.0f;
+            cpu_utilization_ = std::min(100.0f, static_cast<float>(total_cpu_time_.count()) / total_time.count() * 100.0f);
+            occupancy_ = static_cast<float>(total_run_time_.count()) / total_time.count() * 100.0f;
         }
         else
         {
             cpu_utilization_ = 0.0f;
+            occupancy_ = 0.0f;
         }
     }
 
-    void Scheduler::schedulerLoop()
+    template <typename Queue, typename Preemption, typename Lock>
+    float BasicScheduler<Queue, Preemption, Lock>::estimateUtilization(double exceedance_probability)
     {
-        while (is_running_)
-        {
-            std::unique_lock<std::mutex> lock(scheduler_mutex_);
+        std::lock_guard<mutex_type> lock(scheduler_mutex_);
 
-            // Check for deadline misses
-            checkDeadlines();
-
-            // Select the next task to execute
-            auto previous_task = current_task_;
-            current_task_ = selectNextTask();
+        float utilization = 0.0f;
+        for (const auto &task : all_tasks_)
+        {
+            // Only periodic tasks have a defined demand
+            if (task->getPeriod().count() == 0 || task->getState() == TaskState::TERMINATED)
+            {
+                continue;
+            }
 
-            if (current_task_)
+            auto wcet = task->getWcetEstimate(exceedance_probability).probabilistic_wcet;
+            auto period = std::chrono::duration_cast<std::chrono::microseconds>(task->getEffectivePeriod());
+            if (period.count() > 0)
             {
-                // Exit idle state if we were idle
-                exitIdleState();
+                utilization += static_cast<float>(wcet.count()) / period.count() * 100.0f;
+            }
+        }
 
-                // Execute the task
-                auto start_time = std::chrono::steady_clock::now();
+        return utilization;
+    }
 
-                // Unlock during task execution
-                lock.unlock();
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::canAdmit(std::chrono::microseconds wcet,
+                             std::chrono::milliseconds period,
+                             double exceedance_probability,
+                             float utilization_bound)
+    {
+        if (period.count() <= 0)
+        {
+            return false;
+        }
 
-                // Set task to running state
-                current_task_->setState(TaskState::RUNNING);
+        float demand = static_cast<float>(wcet.count()) /
+                       std::chrono::duration_cast<std::chrono::microseconds>(period).count() * 100.0f;
 
-                // Execute the task
-                current_task_->execute();
+        return estimateUtilization(exceedance_probability) + demand <= utilization_bound;
+    }
 
-                lock.lock();
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::schedulerLoop()
+    {
+        while (is_running_)
+        {
+            std::unique_lock<mutex_type> lock(scheduler_mutex_);
 
-                auto end_time = std::chrono::steady_clock::now();
-                auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(
-                    end_time - start_time);
+            if (affinity_changed_.exchange(false) && !pinCurrentThread(cpu_affinity_))
+            {
+                std::cerr << "Failed to set scheduler CPU affinity to " << cpu_affinity_ << std::endl;
+            }
 
-                // Update task statistics
-                current_task_->updateStatistics(execution_time);
+            // Check for deadline misses and release periodic groups that are due
+            checkDeadlines();
+            releaseDueGroups(std::chrono::steady_clock::now());
 
-                // Add to total run time
-                total_run_time_ += execution_time;
+            // Wake tasks on behalf of producers that deferred it to us
+            if (wake_sources_pending_.exchange(false))
+            {
+                processWakeSources();
+            }
 
-                // Check if task failed and needs recovery
-                if (current_task_->getState() == TaskState::TERMINATED &&
-                    current_task_->isRecoverable())
-                {
-                    attemptTaskRecovery(current_task_);
-                }
+            // Select the next task to execute. The dispatch path only handles
+            // borrowed pointers, so it never touches shared_ptr reference counts.
+            Task *task = selectNextTask();
+            current_task_.store(task, std::memory_order_release);
 
-                // Update CPU utilization
-                updateCpuUtilization();
+            if (task)
+            {
+                runJob(*task, lock);
 
                 // Reset the reschedule flag
                 force_reschedule_ = false;
@@ -220,12 +591,17 @@ namespace edurtos
             {
                 // Enter idle state - no tasks to run
                 enterIdleState();
+                EDURTOS_TRACE(SCHEDULER, scheduler, idle_enter);
 
-                // Wait for a task to become ready or for a timeout
-                scheduler_cv_.wait_for(lock, std::chrono::milliseconds(1));
+                // Wait for a task to become ready, the next group release, or a timeout
+                auto wake_time = std::min(std::chrono::steady_clock::now() + std::chrono::milliseconds(1),
+                                          feedback_enabled_ ? next_group_release_ : std::chrono::steady_clock::time_point::max());
+                scheduler_cv_.wait_until(lock, wake_time, [this]()
+                                         { return wakeup_pending_.exchange(false) || !is_running_; });
 
                 // Exit idle state and record idle time
                 exitIdleState();
+                EDURTOS_TRACE(SCHEDULER, scheduler, idle_exit);
             }
 
             // Check if we should preempt the current task
@@ -233,8 +609,8 @@ namespace edurtos
             auto now = std::chrono::steady_clock::now();
 
             // Check if the time slice has expired for preemptive tasks
-            if (current_task_ && current_task_->getPolicy() == SchedulePolicy::PREEMPTIVE &&
-                (preemption_mode_ == PreemptionMode::TIME_SLICE || preemption_mode_ == PreemptionMode::HYBRID))
+            if (task && task->getPolicy() == SchedulePolicy::PREEMPTIVE &&
+                Preemption::timeSlicing(preemption_mode_))
             {
                 time_slice_expired = (now - last_schedule_time_ >= time_slice_);
             }
@@ -244,26 +620,130 @@ namespace edurtos
             {
                 last_schedule_time_ = now;
                 force_reschedule_ = false;
+                EDURTOS_TRACE(SCHEDULER, scheduler, reschedule, task, time_slice_expired);
 
                 // If we have a current task, put it back in the ready queue
-                if (current_task_ && current_task_->getState() == TaskState::READY)
+                if (task && task->getState() == TaskState::READY && isReleased(*task, now))
                 {
-                    ready_queue_.push(current_task_);
+                    ready_queue_.push(*task);
                 }
-                current_task_ = nullptr;
+                current_task_.store(nullptr, std::memory_order_release);
             }
+            releaseRetiredTasks();
 
-            // Periodically adjust priorities
+            // Periodically adjust priorities, or close the loop in feedback mode
             static auto last_priority_adjustment = std::chrono::steady_clock::now();
-            if (now - last_priority_adjustment > std::chrono::seconds(1))
+            if (feedback_enabled_)
+            {
+                if (now - last_control_time_ >= feedback_controller_.getConfig().control_period)
+                {
+                    runFeedbackControl();
+                }
+            }
+            else if (now - last_priority_adjustment > std::chrono::seconds(1))
             {
+                // adjustPriorities() takes the scheduler lock itself
+                lock.unlock();
                 adjustPriorities();
                 last_priority_adjustment = now;
             }
         }
     }
 
-    void Scheduler::deadlineMonitorLoop()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::runJob(Task &task, std::unique_lock<mutex_type> &lock)
+    {
+        // Exit idle state if we were idle
+        exitIdleState();
+
+        // Execute the task
+        auto start_time = std::chrono::steady_clock::now();
+        auto start_cpu_time = threadCpuTime();
+        bool count_perf = updatePerfCounterState();
+        PerfCounterValues start_perf;
+        if (count_perf)
+        {
+            start_perf = readPerfCounters();
+        }
+
+        // Unlock during task execution
+        running_job_ = &task;
+        job_thread_ = std::this_thread::get_id();
+        lock.unlock();
+
+        EDURTOS_TRACE(SCHEDULER, scheduler, dispatch, &task, task.getDynamicPriority());
+
+        // Execute the task
+        task.execute();
+
+        PerfCounterValues end_perf;
+        if (count_perf)
+        {
+            end_perf = readPerfCounters();
+        }
+        auto end_cpu_time = threadCpuTime();
+        auto end_time = std::chrono::steady_clock::now();
+
+        lock.lock();
+        running_job_ = nullptr;
+        job_done_cv_.notify_all();
+
+        auto execution_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            end_time - start_time);
+        auto cpu_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            end_cpu_time - start_cpu_time);
+
+        // Update task statistics
+        task.updateStatistics(execution_time, cpu_time);
+        if (count_perf)
+        {
+            task.addPerfCounters(end_perf - start_perf);
+        }
+
+        EDURTOS_TRACE(SCHEDULER, scheduler, job_complete, &task,
+                      execution_time.count(), cpu_time.count());
+
+        // Add to total run time
+        total_run_time_ += execution_time;
+        total_cpu_time_ += cpu_time;
+
+        // Check if task failed and needs recovery; a removed task stays terminated
+        if (task.getState() == TaskState::TERMINATED &&
+            task.isRecoverable() && !isRetired(task))
+        {
+            attemptTaskRecovery(task);
+        }
+
+        // Update CPU utilization
+        updateCpuUtilization();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::isRetired(const Task &task) const
+    {
+        return std::any_of(retired_tasks_.begin(), retired_tasks_.end(),
+                           [&](const TaskPtr &retired)
+                           { return retired.get() == &task; });
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::releaseRetiredTasks()
+    {
+        // Called with the lock held once the dispatcher is done with the job
+        if (retired_tasks_.empty())
+        {
+            return;
+        }
+        Task *current = current_task_.load(std::memory_order_acquire);
+        if (current && isRetired(*current))
+        {
+            current_task_.store(nullptr, std::memory_order_release);
+        }
+        retired_tasks_.clear();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::deadlineMonitorLoop()
     {
         while (is_running_)
         {
@@ -278,12 +758,17 @@ namespace edurtos
 
             // Update deadline counters for all tasks
             {
-                std::lock_guard<std::mutex> lock(scheduler_mutex_);
+                std::lock_guard<mutex_type> lock(scheduler_mutex_);
+                Task *current = current_task_.load(std::memory_order_acquire);
 
                 for (auto &task : all_tasks_)
                 {
-                    // Only update deadline counters for tasks that aren't currently running
-                    if (task != current_task_ || task->getState() != TaskState::RUNNING)
+                    // Only update deadline counters for tasks that aren't currently running.
+                    // In feedback mode a job's deadline only starts counting at its release,
+                    // and a task blocked on a notification has no job pending at all.
+                    if ((task.get() != current || task->getState() != TaskState::RUNNING) &&
+                        task->getState() != TaskState::BLOCKED &&
+                        isReleased(*task, now))
                     {
                         task->updateDeadlineCounter(elapsed);
                     }
@@ -291,9 +776,9 @@ namespace edurtos
                     // If a high priority task's deadline is approaching, we may need to preempt
                     if (task->isDeadlineApproaching() &&
                         task->getState() == TaskState::READY &&
-                        current_task_ &&
-                        task->getDynamicPriority() > current_task_->getDynamicPriority() &&
-                        (preemption_mode_ == PreemptionMode::PRIORITY || preemption_mode_ == PreemptionMode::HYBRID))
+                        current &&
+                        task->getDynamicPriority() > current->getDynamicPriority() &&
+                        Preemption::priorityPreemption(preemption_mode_))
                     {
                         // Signal that we should reschedule
                         force_reschedule_ = true;
@@ -304,46 +789,118 @@ namespace edurtos
         }
     }
 
-    TaskPtr Scheduler::selectNextTask()
+    template <typename Queue, typename Preemption, typename Lock>
+    Task *BasicScheduler<Queue, Preemption, Lock>::selectNextTask(std::chrono::microseconds budget)
     {
-        // If ready queue is empty, rebuild it from all_tasks_
+        // If ready queue is empty, rebuild it from all_tasks_. While periods
+        // are enforced, periodic tasks only enter through group releases.
         if (ready_queue_.empty())
         {
+            bool enforce_periods = feedback_enabled_;
             for (auto &task : all_tasks_)
             {
-                if (task->getState() == TaskState::READY)
+                if (task->getState() == TaskState::READY &&
+                    (!enforce_periods || task->getPeriod().count() == 0))
                 {
-                    ready_queue_.push(task);
+                    release_batch_.push_back(task.get());
                 }
             }
+            ready_queue_.pushBatch(release_batch_);
+            release_batch_.clear();
         }
 
-        // If still empty, no tasks are ready
-        if (ready_queue_.empty())
+        // Claim the highest priority task. The claim fails if the task was
+        // suspended or terminated after it was queued.
+        Task *selected = nullptr;
+        while (Task *next_task = ready_queue_.pop())
         {
-            return nullptr;
+            // Under a budget, skip jobs whose WCET estimate would not finish in time
+            if (budget != std::chrono::microseconds::max() &&
+                next_task->getWcetEstimate().probabilistic_wcet > budget)
+            {
+                skipped_batch_.push_back(next_task);
+                continue;
+            }
+
+            if (next_task->tryTransition(TaskState::READY, TaskState::RUNNING))
+            {
+                selected = next_task;
+                break;
+            }
         }
 
-        // Get the highest priority task
-        TaskPtr next_task = ready_queue_.top();
-        ready_queue_.pop();
+        ready_queue_.pushBatch(skipped_batch_);
+        skipped_batch_.clear();
 
-        // Double-check task state
-        if (next_task->getState() != TaskState::READY)
+        return selected;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    std::size_t BasicScheduler<Queue, Preemption, Lock>::runUntil(std::chrono::steady_clock::time_point budget_end)
+    {
+        if (is_running_)
         {
-            return selectNextTask(); // Recursively find the next ready task
+            std::cerr << "runUntil() called on a scheduler that runs its own thread" << std::endl;
+            return 0;
         }
 
-        return next_task;
+        std::size_t jobs = 0;
+        std::unique_lock<mutex_type> lock(scheduler_mutex_);
+        for (auto now = std::chrono::steady_clock::now(); now < budget_end; now = std::chrono::steady_clock::now())
+        {
+            checkDeadlines();
+            releaseDueGroups(now);
+            if (wake_sources_pending_.exchange(false))
+            {
+                processWakeSources();
+            }
+
+            auto budget = std::chrono::duration_cast<std::chrono::microseconds>(budget_end - now);
+            Task *task = selectNextTask(budget);
+            if (!task)
+            {
+                break;
+            }
+
+            current_task_.store(task, std::memory_order_release);
+            runJob(*task, lock);
+            current_task_.store(nullptr, std::memory_order_release);
+
+            // Skipped jobs keep the ready queue non-empty, so the rebuild in
+            // selectNextTask() would never bring this task back
+            if (task->getState() == TaskState::READY && isReleased(*task, std::chrono::steady_clock::now()))
+            {
+                ready_queue_.push(*task);
+            }
+            releaseRetiredTasks();
+            jobs++;
+        }
+        return jobs;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::waitForWakeup(std::chrono::steady_clock::time_point until)
+    {
+        std::unique_lock<mutex_type> lock(scheduler_mutex_);
+        return scheduler_cv_.wait_until(lock, until, [this]()
+                                        { return wakeup_pending_.exchange(false); });
     }
 
-    void Scheduler::checkDeadlines()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::checkDeadlines()
     {
+        // While periods are enforced, misses are counted at group releases
+        if (feedback_enabled_)
+        {
+            return;
+        }
+
         auto now = std::chrono::steady_clock::now();
 
         for (auto &task : all_tasks_)
         {
-            if (task->getDeadline().count() > 0 && task->getPeriod().count() > 0)
+            if (task->getDeadline().count() > 0 && task->getPeriod().count() > 0 &&
+                task->getState() != TaskState::BLOCKED)
             {
                 auto last_exec = task->getStatistics().last_execution;
                 if (last_exec.time_since_epoch().count() > 0)
@@ -351,7 +908,7 @@ namespace edurtos
                     auto time_since_last_exec = std::chrono::duration_cast<std::chrono::milliseconds>(
                         now - last_exec);
 
-                    if (time_since_last_exec > task->getPeriod() + task->getDeadline())
+                    if (time_since_last_exec > task->getEffectivePeriod() + task->getEffectiveDeadline())
                     {
                         task->recordDeadlineMiss();
                     }
@@ -360,62 +917,87 @@ namespace edurtos
         }
     }
 
-    bool Scheduler::shouldPreempt(TaskPtr new_task) const
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::shouldPreempt(const Task &new_task) const
     {
         // If there's no current task, no need to preempt
-        if (!current_task_)
+        const Task *current = current_task_.load(std::memory_order_acquire);
+        if (!current)
             return false;
 
         // If the current task is cooperative, don't preempt
-        if (current_task_->getPolicy() == SchedulePolicy::COOPERATIVE)
-            return false;
-
-        // Check based on preemption mode
-        switch (preemption_mode_)
-        {
-        case PreemptionMode::NONE:
-            return false;
-
-        case PreemptionMode::PRIORITY:
-            // Preempt if new task has higher priority
-            return new_task->getDynamicPriority() > current_task_->getDynamicPriority();
-
-        case PreemptionMode::TIME_SLICE:
-            // Time slice preemption is handled in the scheduler loop
+        if (current->getPolicy() == SchedulePolicy::COOPERATIVE)
             return false;
 
-        case PreemptionMode::HYBRID:
-            // Preempt if new task has higher priority
-            return new_task->getDynamicPriority() > current_task_->getDynamicPriority();
-        }
-
-        return false;
+        // Time slice preemption is handled in the scheduler loop; the policy
+        // decides whether a higher priority task ends the slot early
+        return Preemption::priorityPreemption(preemption_mode_) &&
+               new_task.getDynamicPriority() > current->getDynamicPriority();
     }
 
-    bool Scheduler::attemptTaskRecovery(TaskPtr task)
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::attemptTaskRecovery(Task &task)
     {
-        if (!task->isRecoverable())
+        if (!task.isRecoverable())
         {
             return false;
         }
 
         if (recovery_attempts_ >= MAX_RECOVERY_ATTEMPTS)
         {
-            std::cerr << "Max recovery attempts reached for task: " << task->getName() << std::endl;
+            std::cerr << "Max recovery attempts reached for task: " << task.getName() << std::endl;
             return false;
         }
 
-        std::cout << "Attempting recovery for task: " << task->getName() << std::endl;
         recovery_attempts_++;
+        EDURTOS_TRACE(SCHEDULER, scheduler, recovery, &task, recovery_attempts_.load());
 
         // Set task back to READY state
-        task->setState(TaskState::READY);
+        if (!task.tryTransition(TaskState::TERMINATED, TaskState::READY))
+        {
+            return false;
+        }
         ready_queue_.push(task);
 
         return true;
     }
 
-    char Scheduler::getSymbolForTaskState(TaskState state)
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::onTaskStateChange(Task &task, TaskState from, TaskState to)
+    {
+        // Called on the thread that changed the state, possibly with the
+        // scheduler lock held; only the ready queue's own lock is taken here
+        switch (to)
+        {
+        case TaskState::SUSPENDED:
+        case TaskState::BLOCKED:
+        case TaskState::TERMINATED:
+            ready_queue_.remove(task);
+            break;
+
+        case TaskState::READY:
+            // Jobs that just completed wait for the next round; resumed and
+            // unblocked tasks are queued right away, except periodic ones
+            // while periods are enforced, which rejoin at their next group
+            // release (the groups need the scheduler lock)
+            if (from == TaskState::SUSPENDED || from == TaskState::BLOCKED)
+            {
+                if (!feedback_enabled_ || task.getPeriod().count() == 0)
+                {
+                    ready_queue_.push(task);
+                }
+                wakeup_pending_ = true;
+                scheduler_cv_.notify_one();
+            }
+            break;
+
+        case TaskState::RUNNING:
+            break;
+        }
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    char BasicScheduler<Queue, Preemption, Lock>::getSymbolForTaskState(TaskState state)
     {
         switch (state)
         {
@@ -434,45 +1016,35 @@ namespace edurtos
         }
     }
 
-    void Scheduler::printTaskStates()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::printTaskStates()
     {
         std::cout << getTaskStateVisualization() << std::endl;
     }
 
-    std::string Scheduler::getTaskStateVisualization()
+    template <typename Queue, typename Preemption, typename Lock>
+    std::string BasicScheduler<Queue, Preemption, Lock>::getTaskStateVisualization()
     {
-        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        auto state = snapshot();
         std::stringstream ss;
 
         // Ensure we have tasks to visualize
-        if (all_tasks_.empty())
+        if (state->tasks.empty())
         {
             return "No tasks registered in the scheduler.";
         }
 
-        // Create a map for task symbols if it doesn't exist
-        if (task_symbols_.empty())
-        {
-            char symbol = 'A';
-            for (const auto &task : all_tasks_)
-            {
-                task_symbols_[task] = symbol++;
-            }
-        }
-
         // Header row with task symbols
         ss << "Time | ";
-        for (const auto &task : all_tasks_)
+        for (const auto &task : state->tasks)
         {
-            auto it = task_symbols_.find(task);
-            char symbol = (it != task_symbols_.end()) ? it->second : '?';
-            ss << symbol << " ";
+            ss << task.symbol << " ";
         }
         ss << "| Tasks\n";
 
         // Separator
         ss << "-----|-";
-        for (size_t i = 0; i < all_tasks_.size(); i++)
+        for (size_t i = 0; i < state->tasks.size(); i++)
         {
             ss << "--";
         }
@@ -480,40 +1052,154 @@ namespace edurtos
 
         // Current state
         ss << "now  | ";
-        for (const auto &task : all_tasks_)
+        for (const auto &task : state->tasks)
         {
-            ss << getSymbolForTaskState(task->getState()) << " ";
+            ss << getSymbolForTaskState(task.state) << " ";
         }
         ss << "| ";
 
         // Print task names and priorities
         bool first = true;
-        for (const auto &task : all_tasks_)
+        for (const auto &task : state->tasks)
         {
             if (!first)
                 ss << ", ";
             first = false;
 
-            auto it = task_symbols_.find(task);
-            char symbol = (it != task_symbols_.end()) ? it->second : '?';
-
-            ss << symbol << ":" << task->getName()
-               << "(" << static_cast<int>(task->getDynamicPriority()) << ")";
+            ss << task.symbol << ":" << task.name
+               << "(" << static_cast<int>(task.dynamic_priority) << ")";
         }
 
         return ss.str();
     }
 
-    void Scheduler::enterIdleState()
+    template <typename Queue, typename Preemption, typename Lock>
+    std::shared_ptr<const SchedulerSnapshot> BasicScheduler<Queue, Preemption, Lock>::snapshot()
+    {
+        auto current = snapshot_.load(std::memory_order_acquire);
+        auto interval = std::chrono::milliseconds(snapshot_interval_ms_.load(std::memory_order_relaxed));
+        if (current && std::chrono::steady_clock::now() - current->timestamp < interval)
+        {
+            return current;
+        }
+
+        // One consumer rebuilds; the others keep using the previous snapshot
+        // rather than piling onto the scheduler mutex
+        if (snapshot_building_.exchange(true, std::memory_order_acquire))
+        {
+            return current ? current : buildSnapshot();
+        }
+
+        auto fresh = buildSnapshot();
+        snapshot_.store(fresh, std::memory_order_release);
+        snapshot_building_.store(false, std::memory_order_release);
+        return fresh;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    std::shared_ptr<const SchedulerSnapshot> BasicScheduler<Queue, Preemption, Lock>::buildSnapshot()
+    {
+        auto snapshot = std::make_shared<SchedulerSnapshot>();
+        std::vector<std::pair<TaskPtr, char>> tasks;
+        const Task *current = nullptr;
+
+        {
+            // Only copy references and globals under the lock
+            std::lock_guard<mutex_type> lock(scheduler_mutex_);
+            snapshot->sequence = ++snapshot_sequence_;
+            snapshot->total_run_time = total_run_time_;
+            snapshot->total_idle_time = total_idle_time_;
+            snapshot->total_cpu_time = total_cpu_time_;
+            current = current_task_.load(std::memory_order_acquire);
+
+            tasks.reserve(all_tasks_.size());
+            for (const auto &task : all_tasks_)
+            {
+                auto it = task_symbols_.find(task);
+                tasks.emplace_back(task, it != task_symbols_.end() ? it->second : '?');
+            }
+        }
+
+        snapshot->timestamp = std::chrono::steady_clock::now();
+        snapshot->cpu_utilization = cpu_utilization_;
+        snapshot->occupancy = occupancy_;
+        snapshot->recovery_attempts = recovery_attempts_;
+        snapshot->feedback_enabled = feedback_enabled_;
+        if (snapshot->feedback_enabled)
+        {
+            snapshot->feedback = feedback_controller_.getLastSample();
+        }
+
+        snapshot->tasks.reserve(tasks.size());
+        for (const auto &[task, symbol] : tasks)
+        {
+            if (task.get() == current)
+            {
+                snapshot->current_task = static_cast<int>(snapshot->tasks.size());
+            }
+            snapshot->tasks.push_back(TaskSnapshot::capture(*task, symbol));
+        }
+
+        return snapshot;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    bool BasicScheduler<Queue, Preemption, Lock>::updatePerfCounterState()
+    {
+        // Counters belong to the scheduler thread, so open and close them here
+        if (perf_enabled_ && !perf_counters_.isOpen())
+        {
+            perf_counters_.open();
+            perf_mode_ = perf_counters_.getMode();
+        }
+        else if (!perf_enabled_ && perf_counters_.isOpen())
+        {
+            perf_counters_.close();
+            perf_mode_ = PerfCounterMode::UNAVAILABLE;
+        }
+
+        return perf_counters_.isOpen();
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    PerfCounterValues BasicScheduler<Queue, Preemption, Lock>::readPerfCounters()
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto values = perf_counters_.read();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        perf_overhead_ns_ += elapsed.count();
+        perf_reads_++;
+        return values;
+    }
+
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::enterIdleState()
     {
         idle_start_time_ = std::chrono::steady_clock::now();
+        is_idle_ = true;
     }
 
-    void Scheduler::exitIdleState()
+    template <typename Queue, typename Preemption, typename Lock>
+    void BasicScheduler<Queue, Preemption, Lock>::exitIdleState()
     {
+        // Only account idle time once per idle period
+        if (!is_idle_)
+        {
+            return;
+        }
+        is_idle_ = false;
+
         auto now = std::chrono::steady_clock::now();
         auto idle_time = std::chrono::duration_cast<std::chrono::microseconds>(now - idle_start_time_);
         total_idle_time_ += idle_time;
     }
 
+    // The supported configurations; other combinations need an entry here
+    template class BasicScheduler<ReadyQueue, RuntimePreemption, MutexLock>;
+    template class BasicScheduler<ReadyQueue, NoPreemption, NoLock>;
+    template class BasicScheduler<EdfQueue, RuntimePreemption, MutexLock>;
+    template class BasicScheduler<EdfQueue, NoPreemption, NoLock>;
+
 } // namespace edurtos
@@ -0,0 +1,85 @@
+#include "../../include/kernel/scheduler_snapshot.hpp"
+
+namespace edurtos
+{
+    TaskSnapshot TaskSnapshot::capture(const Task &task, char symbol)
+    {
+        TaskSnapshot snapshot;
+        snapshot.task = &task;
+        snapshot.id = task.getId();
+        snapshot.name = task.getName();
+        snapshot.symbol = symbol;
+        snapshot.state = task.getState();
+        snapshot.base_priority = task.getBasePriority();
+        snapshot.dynamic_priority = task.getDynamicPriority();
+        snapshot.period = task.getPeriod();
+        snapshot.deadline = task.getDeadline();
+        snapshot.rate_scale = task.getRateScale();
+        snapshot.statistics = task.getStatistics();
+
+        if (snapshot.deadline.count() > 0)
+        {
+            snapshot.deadline_percent = 100.0f *
+                                        snapshot.statistics.deadline_counter.count() /
+                                        snapshot.deadline.count();
+        }
+
+        return snapshot;
+    }
+
+    const TaskSnapshot *SchedulerSnapshot::findTask(const Task *task) const
+    {
+        for (const auto &entry : tasks)
+        {
+            if (entry.task == task)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    const TaskSnapshot *SchedulerSnapshot::findTask(const std::string &name) const
+    {
+        for (const auto &entry : tasks)
+        {
+            if (entry.name == name)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    const TaskSnapshot *SchedulerSnapshot::findTask(std::uint32_t id) const
+    {
+        for (const auto &entry : tasks)
+        {
+            if (entry.id == id)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    const char *taskStateName(TaskState state)
+    {
+        switch (state)
+        {
+        case TaskState::READY:
+            return "READY";
+        case TaskState::RUNNING:
+            return "RUNNING";
+        case TaskState::BLOCKED:
+            return "BLOCKED";
+        case TaskState::SUSPENDED:
+            return "SUSPENDED";
+        case TaskState::TERMINATED:
+            return "TERMINATED";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+} // namespace edurtos
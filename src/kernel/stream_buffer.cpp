@@ -0,0 +1,203 @@
+#include "../../include/kernel/stream_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace edurtos
+{
+    StreamBuffer::StreamBuffer(std::size_t capacity, std::size_t trigger_level)
+    {
+        capacity_ = 2;
+        while (capacity_ < capacity)
+        {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        storage_ = std::make_unique<std::byte[]>(capacity_);
+        trigger_level_ = std::clamp<std::size_t>(trigger_level, 1, capacity_);
+    }
+
+    std::size_t StreamBuffer::send(const void *data, std::size_t length)
+    {
+        std::size_t write = write_position_.load(std::memory_order_relaxed);
+        std::size_t free = capacity_ - (write - read_position_.load(std::memory_order_acquire));
+        length = std::min(length, free);
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        copyIn(write, data, length);
+        commit(length);
+        return length;
+    }
+
+    std::span<std::byte> StreamBuffer::writeRegion()
+    {
+        std::size_t write = write_position_.load(std::memory_order_relaxed);
+        std::size_t free = capacity_ - (write - read_position_.load(std::memory_order_acquire));
+        std::size_t offset = write & mask_;
+        return {storage_.get() + offset, std::min(free, capacity_ - offset)};
+    }
+
+    void StreamBuffer::commit(std::size_t length)
+    {
+        std::size_t write = write_position_.load(std::memory_order_relaxed) + length;
+        write_position_.store(write, std::memory_order_release);
+        wakeReader(write - read_position_.load(std::memory_order_acquire));
+    }
+
+    std::size_t StreamBuffer::receive(void *data, std::size_t max_length)
+    {
+        std::size_t read = read_position_.load(std::memory_order_relaxed);
+        std::size_t length = std::min(max_length, write_position_.load(std::memory_order_acquire) - read);
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        copyOut(read, data, length);
+        read_position_.store(read + length, std::memory_order_release);
+        return length;
+    }
+
+    std::span<const std::byte> StreamBuffer::readRegion() const
+    {
+        std::size_t read = read_position_.load(std::memory_order_relaxed);
+        std::size_t available = write_position_.load(std::memory_order_acquire) - read;
+        std::size_t offset = read & mask_;
+        return {storage_.get() + offset, std::min(available, capacity_ - offset)};
+    }
+
+    void StreamBuffer::consume(std::size_t length)
+    {
+        read_position_.store(read_position_.load(std::memory_order_relaxed) + length, std::memory_order_release);
+    }
+
+    bool StreamBuffer::waitForData()
+    {
+        if (bytesAvailable() >= trigger_level_)
+        {
+            return true;
+        }
+
+        // Publish the wait, then re-check: the producer may have crossed the
+        // trigger level before it could see the flag
+        reader_waiting_.store(true);
+        if (bytesAvailable() >= trigger_level_)
+        {
+            reader_waiting_.store(false);
+            return true;
+        }
+
+        // A notification that raced in leaves the task READY, so it simply
+        // runs again and finds the data. Only the pending flag is consumed;
+        // counts from other notifiers of this task stay in its value.
+        if (Task *self = Task::current())
+        {
+            std::uint32_t value;
+            self->waitForNotification(value, 0);
+        }
+        return false;
+    }
+
+    void StreamBuffer::setTriggerLevel(std::size_t level)
+    {
+        trigger_level_ = std::clamp<std::size_t>(level, 1, capacity_);
+    }
+
+    std::size_t StreamBuffer::bytesAvailable() const
+    {
+        std::size_t read = read_position_.load(std::memory_order_acquire);
+        return write_position_.load(std::memory_order_acquire) - read;
+    }
+
+    void StreamBuffer::reset()
+    {
+        write_position_ = 0;
+        read_position_ = 0;
+        reader_waiting_ = false;
+    }
+
+    void StreamBuffer::copyIn(std::size_t position, const void *data, std::size_t length)
+    {
+        std::size_t offset = position & mask_;
+        std::size_t first = std::min(length, capacity_ - offset);
+        std::memcpy(storage_.get() + offset, data, first);
+        std::memcpy(storage_.get(), static_cast<const std::byte *>(data) + first, length - first);
+    }
+
+    void StreamBuffer::copyOut(std::size_t position, void *data, std::size_t length) const
+    {
+        std::size_t offset = position & mask_;
+        std::size_t first = std::min(length, capacity_ - offset);
+        std::memcpy(data, storage_.get() + offset, first);
+        std::memcpy(static_cast<std::byte *>(data) + first, storage_.get(), length - first);
+    }
+
+    void StreamBuffer::wakeReader(std::size_t available)
+    {
+        // Only the send that crosses the trigger level pays for the wakeup
+        if (available < trigger_level_ || !reader_waiting_.load() || !reader_waiting_.exchange(false))
+        {
+            return;
+        }
+
+        if (auto reader = reader_.lock())
+        {
+            reader->notify(0, NotifyAction::NO_ACTION);
+        }
+    }
+
+    MessageBuffer::MessageBuffer(std::size_t capacity)
+        : stream_(capacity, sizeof(LengthType))
+    {
+    }
+
+    bool MessageBuffer::send(const void *data, std::size_t length)
+    {
+        if (length > UINT32_MAX || stream_.spacesAvailable() < sizeof(LengthType) + length)
+        {
+            return false;
+        }
+
+        // Prefix and payload become visible to the reader in one commit
+        LengthType prefix = static_cast<LengthType>(length);
+        std::size_t write = stream_.write_position_.load(std::memory_order_relaxed);
+        stream_.copyIn(write, &prefix, sizeof(prefix));
+        stream_.copyIn(write + sizeof(prefix), data, length);
+        stream_.commit(sizeof(prefix) + length);
+        return true;
+    }
+
+    std::size_t MessageBuffer::receive(void *data, std::size_t max_length)
+    {
+        std::size_t length = nextMessageLength();
+        if (length == 0 || length > max_length)
+        {
+            // Zero-length messages are consumed silently
+            if (length == 0 && !stream_.empty())
+            {
+                stream_.consume(sizeof(LengthType));
+            }
+            return 0;
+        }
+
+        std::size_t read = stream_.read_position_.load(std::memory_order_relaxed);
+        stream_.copyOut(read + sizeof(LengthType), data, length);
+        stream_.consume(sizeof(LengthType) + length);
+        return length;
+    }
+
+    std::size_t MessageBuffer::nextMessageLength() const
+    {
+        if (stream_.bytesAvailable() < sizeof(LengthType))
+        {
+            return 0;
+        }
+
+        LengthType length;
+        stream_.copyOut(stream_.read_position_.load(std::memory_order_relaxed), &length, sizeof(length));
+        return length;
+    }
+
+} // namespace edurtos
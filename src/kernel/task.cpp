@@ -1,7 +1,15 @@
 #include "../../include/kernel/task.hpp"
+#include "../../include/kernel/task_event_bus.hpp"
+#include "../../include/util/trace.hpp"
 
 namespace edurtos
 {
+    template <typename T>
+    thread_local TaskBase<T> *TaskBase<T>::current_ = nullptr;
+
+    template <typename T>
+    std::atomic<std::uint32_t> TaskBase<T>::next_id_{1};
+
     template <typename T>
     TaskBase<T>::TaskBase(std::string name,
                           std::function<void()> handler,
@@ -11,7 +19,8 @@ namespace edurtos
                           std::chrono::milliseconds deadline,
                           std::size_t stack_size,
                           bool recoverable)
-        : name_(std::move(name)),
+        : id_(next_id_.fetch_add(1, std::memory_order_relaxed)),
+          name_(std::move(name)),
           handler_(std::move(handler)),
           policy_(policy),
           base_priority_(std::min<std::uint8_t>(priority, 99)), // Ensure priority is in 1-99 range
@@ -23,64 +32,298 @@ namespace edurtos
     {
     }
 
+    template <typename T>
+    bool TaskBase<T>::isLegalTransition(TaskState from, TaskState to)
+    {
+        switch (from)
+        {
+        case TaskState::READY:
+        case TaskState::RUNNING:
+            return to != from;
+        case TaskState::BLOCKED:
+            return to == TaskState::READY || to == TaskState::SUSPENDED || to == TaskState::TERMINATED;
+        case TaskState::SUSPENDED:
+            return to == TaskState::READY || to == TaskState::TERMINATED;
+        case TaskState::TERMINATED:
+            return to == TaskState::READY; // Recovery
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool TaskBase<T>::tryTransition(TaskState expected, TaskState desired)
+    {
+        if (!isLegalTransition(expected, desired) ||
+            !state_.compare_exchange_strong(expected, desired))
+        {
+            return false;
+        }
+
+        notifyStateChange(expected, desired);
+        return true;
+    }
+
+    template <typename T>
+    bool TaskBase<T>::changeState(TaskState state)
+    {
+        TaskState previous = state_.load();
+        do
+        {
+            if (previous == state)
+            {
+                return true;
+            }
+            if (!isLegalTransition(previous, state))
+            {
+                EDURTOS_TRACE(TASK, task, illegal_transition, this, previous, state);
+                return false;
+            }
+        } while (!state_.compare_exchange_weak(previous, state));
+
+        notifyStateChange(previous, state);
+        return true;
+    }
+
+    template <typename T>
+    void TaskBase<T>::notifyStateChange(TaskState from, TaskState to)
+    {
+        if (TaskStateListener<T> *listener = state_listener_.load(std::memory_order_acquire))
+        {
+            listener->onTaskStateChange(*this, from, to);
+        }
+
+        TaskEventBus *bus = event_bus_.load(std::memory_order_acquire);
+        if (bus && bus->hasSubscribers())
+        {
+            bus->publish(id_, from, to);
+        }
+    }
+
     template <typename T>
     void TaskBase<T>::execute()
     {
-        state_ = TaskState::RUNNING;
+        // The scheduler claims the task (READY -> RUNNING) before dispatching;
+        // direct callers are claimed here. Suspended or terminated tasks do not run.
+        if (state_ != TaskState::RUNNING && !tryTransition(TaskState::READY, TaskState::RUNNING))
+        {
+            return;
+        }
+
+        EDURTOS_TRACE(TASK, task, execute_begin, this);
         statistics_.last_execution = std::chrono::steady_clock::now();
         statistics_.execution_count++;
         // Reset deadline counter when task starts execution
         statistics_.deadline_counter = std::chrono::milliseconds(0);
 
+        // A notification wait only lasts for the job that armed it
+        notification_.fetch_and(~NOTIFY_WAITING);
+
+        current_ = this;
         try
         {
             handler_();
         }
         catch (...)
         {
-            // Task execution failed
+            current_ = nullptr;
+
+            // Task execution failed. A suspend or terminate issued while the job
+            // ran takes precedence over the job's own outcome.
+            EDURTOS_TRACE(TASK, task, exception, this, recoverable_);
             if (!recoverable_)
             {
-                state_ = TaskState::TERMINATED;
+                changeState(TaskState::TERMINATED);
             }
             else
             {
-                state_ = TaskState::READY;
+                finishJob();
             }
             return;
         }
+        current_ = nullptr;
 
-        state_ = TaskState::READY;
+        finishJob();
+        EDURTOS_TRACE(TASK, task, execute_end, this);
     }
 
     template <typename T>
-    void TaskBase<T>::suspend()
+    void TaskBase<T>::finishJob()
     {
-        if (state_ != TaskState::TERMINATED)
+        if (!(notification_.load() & NOTIFY_WAITING))
+        {
+            tryTransition(TaskState::RUNNING, TaskState::READY);
+            return;
+        }
+
+        // Block first, then re-check: a notify() that cleared the wait bit
+        // while the job was still running could not wake the task itself
+        if (tryTransition(TaskState::RUNNING, TaskState::BLOCKED) &&
+            !(notification_.load() & NOTIFY_WAITING))
         {
-            state_ = TaskState::SUSPENDED;
+            tryTransition(TaskState::BLOCKED, TaskState::READY);
         }
     }
 
     template <typename T>
-    void TaskBase<T>::resume()
+    bool TaskBase<T>::notify(std::uint32_t value, NotifyAction action)
     {
-        if (state_ == TaskState::SUSPENDED)
+        std::uint64_t previous = notification_.load();
+        std::uint64_t next;
+        do
+        {
+            std::uint32_t current = static_cast<std::uint32_t>(previous & NOTIFY_VALUE_MASK);
+            switch (action)
+            {
+            case NotifyAction::NO_ACTION:
+                break;
+            case NotifyAction::SET_BITS:
+                current |= value;
+                break;
+            case NotifyAction::INCREMENT:
+                current++;
+                break;
+            case NotifyAction::SET_VALUE_WITH_OVERWRITE:
+                current = value;
+                break;
+            case NotifyAction::SET_VALUE_WITHOUT_OVERWRITE:
+                if (previous & NOTIFY_PENDING)
+                {
+                    return false;
+                }
+                current = value;
+                break;
+            }
+            next = current | NOTIFY_PENDING;
+        } while (!notification_.compare_exchange_weak(previous, next));
+
+        EDURTOS_TRACE(TASK, task, notify, this, action, value);
+
+        // Whoever clears the wait bit wakes the task. If the job is still
+        // running this fails harmlessly and finishJob() sees the cleared bit.
+        if (previous & NOTIFY_WAITING)
         {
-            state_ = TaskState::READY;
+            tryTransition(TaskState::BLOCKED, TaskState::READY);
         }
+        return true;
     }
 
     template <typename T>
-    void TaskBase<T>::terminate()
+    bool TaskBase<T>::waitForNotification(std::uint32_t &value, std::uint32_t clear_bits_on_exit)
     {
-        state_ = TaskState::TERMINATED;
+        std::uint64_t previous = notification_.load();
+        std::uint64_t next;
+        do
+        {
+            if (previous & NOTIFY_PENDING)
+            {
+                next = previous & NOTIFY_VALUE_MASK & ~static_cast<std::uint64_t>(clear_bits_on_exit);
+            }
+            else
+            {
+                next = previous | NOTIFY_WAITING;
+            }
+        } while (!notification_.compare_exchange_weak(previous, next));
+
+        if (!(previous & NOTIFY_PENDING))
+        {
+            return false;
+        }
+
+        value = static_cast<std::uint32_t>(previous & NOTIFY_VALUE_MASK);
+        return true;
+    }
+
+    template <typename T>
+    std::uint32_t TaskBase<T>::takeNotification(bool clear_count)
+    {
+        std::uint64_t previous = notification_.load();
+        std::uint64_t next;
+        do
+        {
+            std::uint32_t count = static_cast<std::uint32_t>(previous & NOTIFY_VALUE_MASK);
+            if (count == 0)
+            {
+                next = NOTIFY_WAITING;
+            }
+            else if (clear_count || count == 1)
+            {
+                next = 0;
+            }
+            else
+            {
+                next = (count - 1) | NOTIFY_PENDING;
+            }
+        } while (!notification_.compare_exchange_weak(previous, next));
+
+        return static_cast<std::uint32_t>(previous & NOTIFY_VALUE_MASK);
+    }
+
+    template <typename T>
+    bool TaskBase<T>::armNotificationWait()
+    {
+        std::uint64_t previous = notification_.load();
+        do
+        {
+            if (previous & NOTIFY_PENDING)
+            {
+                return false;
+            }
+        } while (!notification_.compare_exchange_weak(previous, previous | NOTIFY_WAITING));
+        return true;
+    }
+
+    template <typename T>
+    TaskBase<T> *TaskBase<T>::current()
+    {
+        return current_;
+    }
+
+    template <typename T>
+    bool TaskBase<T>::suspend()
+    {
+        TaskState previous = state_.load();
+        do
+        {
+            if (previous == TaskState::SUSPENDED || !isLegalTransition(previous, TaskState::SUSPENDED))
+            {
+                return false;
+            }
+        } while (!state_.compare_exchange_weak(previous, TaskState::SUSPENDED));
+
+        notifyStateChange(previous, TaskState::SUSPENDED);
+        EDURTOS_TRACE(TASK, task, suspend, this);
+        return true;
+    }
+
+    template <typename T>
+    bool TaskBase<T>::resume()
+    {
+        if (!tryTransition(TaskState::SUSPENDED, TaskState::READY))
+        {
+            return false;
+        }
+
+        EDURTOS_TRACE(TASK, task, resume, this);
+        return true;
+    }
+
+    template <typename T>
+    bool TaskBase<T>::terminate()
+    {
+        if (state_ == TaskState::TERMINATED || !changeState(TaskState::TERMINATED))
+        {
+            return false;
+        }
+
+        EDURTOS_TRACE(TASK, task, terminate, this);
+        return true;
     }
 
     template <typename T>
     void TaskBase<T>::recordDeadlineMiss()
     {
         statistics_.deadline_misses++;
+        EDURTOS_TRACE(TASK, task, deadline_miss, this, statistics_.deadline_misses);
         updatePriority();
     }
 
@@ -102,16 +345,36 @@ namespace edurtos
     }
 
     template <typename T>
-    void TaskBase<T>::updateStatistics(std::chrono::microseconds execution_time)
+    void TaskBase<T>::updateStatistics(std::chrono::microseconds execution_time,
+                                       std::chrono::microseconds cpu_time)
     {
         statistics_.total_execution_time += execution_time;
+        statistics_.total_cpu_time += cpu_time;
+        wcet_estimator_.addSample(execution_time);
         if (statistics_.execution_count > 0)
         {
             statistics_.average_execution_time = std::chrono::microseconds(
                 statistics_.total_execution_time.count() / statistics_.execution_count);
+            statistics_.average_cpu_time = std::chrono::microseconds(
+                statistics_.total_cpu_time.count() / statistics_.execution_count);
         }
     }
 
+    template <typename T>
+    std::chrono::milliseconds TaskBase<T>::getEffectivePeriod() const
+    {
+        // A rate scale below 1.0 stretches the period (and the deadline with it)
+        return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(
+            period_.count() / rate_scale_.load()));
+    }
+
+    template <typename T>
+    std::chrono::milliseconds TaskBase<T>::getEffectiveDeadline() const
+    {
+        return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(
+            deadline_.count() / rate_scale_.load()));
+    }
+
     template <typename T>
     void TaskBase<T>::updateDeadlineCounter(std::chrono::milliseconds elapsed)
     {
@@ -120,7 +383,7 @@ namespace edurtos
             statistics_.deadline_counter += elapsed;
 
             // Check if deadline is exceeded
-            if (statistics_.deadline_counter > deadline_)
+            if (statistics_.deadline_counter > getEffectiveDeadline())
             {
                 recordDeadlineMiss();
                 // Reset deadline counter
@@ -136,7 +399,7 @@ namespace edurtos
             return false;
 
         // Consider deadline approaching if 80% of deadline time has passed
-        return statistics_.deadline_counter > (deadline_ * 4 / 5);
+        return statistics_.deadline_counter > (getEffectiveDeadline() * 4 / 5);
     }
 
     template <typename T>
@@ -146,7 +409,11 @@ namespace edurtos
         statistics_.deadline_misses = 0;
         statistics_.total_execution_time = std::chrono::microseconds(0);
         statistics_.average_execution_time = std::chrono::microseconds(0);
+        statistics_.total_cpu_time = std::chrono::microseconds(0);
+        statistics_.average_cpu_time = std::chrono::microseconds(0);
+        statistics_.perf_counters = PerfCounterValues{};
         statistics_.deadline_counter = std::chrono::milliseconds(0);
+        wcet_estimator_.reset();
         dynamic_priority_ = base_priority_;
     }
 
@@ -0,0 +1,113 @@
+#include "../../include/kernel/task_event_bus.hpp"
+#include <algorithm>
+
+namespace edurtos
+{
+    TaskEventSubscription::TaskEventSubscription(std::size_t capacity)
+        : queue_(capacity)
+    {
+    }
+
+    void TaskEventSubscription::push(const TaskEvent &event)
+    {
+        if (!queue_.tryPush(event))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        received_.fetch_add(1, std::memory_order_relaxed);
+
+        // The queue positions are relaxed, so order the enqueue against the
+        // threshold load with a fence. Pairs with the fence in waitForEvents():
+        // either the consumer sees the event or the publisher sees the waiter.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::size_t threshold = wake_threshold_.load(std::memory_order_relaxed);
+        if (threshold != 0 && queue_.size() >= threshold)
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cv_.notify_one();
+        }
+    }
+
+    std::size_t TaskEventSubscription::poll(std::vector<TaskEvent> &out, std::size_t max_events)
+    {
+        std::size_t count = 0;
+        TaskEvent event;
+        while (count < max_events && queue_.tryPop(event))
+        {
+            out.push_back(event);
+            count++;
+        }
+        return count;
+    }
+
+    bool TaskEventSubscription::waitForEvents(std::chrono::milliseconds timeout, std::size_t min_batch)
+    {
+        min_batch = std::max<std::size_t>(1, std::min(min_batch, queue_.capacity()));
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wake_threshold_.store(min_batch, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // See push()
+        bool ready = wait_cv_.wait_for(lock, timeout, [&]()
+                                       { return queue_.size() >= min_batch; });
+        wake_threshold_.store(0, std::memory_order_relaxed);
+        return ready;
+    }
+
+    TaskEventBus::TaskEventBus()
+    {
+        replaceSubscribers(std::make_unique<const SubscriberList>());
+    }
+
+    TaskEventSubscriptionPtr TaskEventBus::subscribe(std::size_t capacity)
+    {
+        auto subscription = std::make_shared<TaskEventSubscription>(capacity);
+
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        auto updated = std::make_unique<SubscriberList>(*subscribers_.load(std::memory_order_relaxed));
+        updated->push_back(subscription);
+        replaceSubscribers(std::move(updated));
+        return subscription;
+    }
+
+    void TaskEventBus::unsubscribe(const TaskEventSubscriptionPtr &subscription)
+    {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        auto updated = std::make_unique<SubscriberList>(*subscribers_.load(std::memory_order_relaxed));
+        updated->erase(std::remove(updated->begin(), updated->end(), subscription), updated->end());
+        replaceSubscribers(std::move(updated));
+    }
+
+    void TaskEventBus::replaceSubscribers(std::unique_ptr<const SubscriberList> updated)
+    {
+        // The previous list stays in lists_: there is no cheap way to know when
+        // the last publisher has finished walking it
+        has_subscribers_ = !updated->empty();
+        subscribers_.store(updated.get(), std::memory_order_release);
+        lists_.push_back(std::move(updated));
+    }
+
+    void TaskEventBus::publish(const TaskEvent &event)
+    {
+        published_.fetch_add(1, std::memory_order_relaxed);
+
+        const SubscriberList *subscribers = subscribers_.load(std::memory_order_acquire);
+        for (const auto &subscription : *subscribers)
+        {
+            subscription->push(event);
+        }
+    }
+
+    void TaskEventBus::publish(std::uint32_t task_id, TaskState from, TaskState to)
+    {
+        TaskEvent event;
+        event.timestamp_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                            std::chrono::steady_clock::now().time_since_epoch())
+                                                            .count());
+        event.task_id = task_id;
+        event.from = from;
+        event.to = to;
+        publish(event);
+    }
+
+} // namespace edurtos
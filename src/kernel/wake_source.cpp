@@ -0,0 +1,24 @@
+#include "../../include/kernel/wake_source.hpp"
+
+namespace edurtos
+{
+    void WakeSource::requestWakeup()
+    {
+        WakeSourceHost *scheduler = scheduler_.load(std::memory_order_acquire);
+        if (!scheduler || wake_requested_.load(std::memory_order_relaxed) || wake_requested_.exchange(true))
+        {
+            return;
+        }
+
+        scheduler->signalWakeSources();
+    }
+
+    void WakeSource::detachScheduler()
+    {
+        if (WakeSourceHost *scheduler = scheduler_.load())
+        {
+            scheduler->removeWakeSource(*this);
+        }
+    }
+
+} // namespace edurtos
@@ -0,0 +1,247 @@
+#include "../../include/kernel/wcet_estimator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace edurtos
+{
+    namespace
+    {
+        constexpr double EULER_GAMMA = 0.5772156649015329;
+        constexpr double PI = 3.14159265358979323846;
+    }
+
+    // P2Quantile Implementation
+    P2Quantile::P2Quantile(double probability)
+        : probability_(std::clamp(probability, 0.0, 1.0))
+    {
+        reset();
+    }
+
+    void P2Quantile::reset()
+    {
+        count_ = 0;
+        heights_.fill(0.0);
+        positions_ = {1.0, 2.0, 3.0, 4.0, 5.0};
+        desired_ = {1.0, 1.0 + 2.0 * probability_, 1.0 + 4.0 * probability_, 3.0 + 2.0 * probability_, 5.0};
+        increments_ = {0.0, probability_ / 2.0, probability_, (1.0 + probability_) / 2.0, 1.0};
+    }
+
+    void P2Quantile::add(double sample)
+    {
+        // Collect the first five samples as initial marker heights
+        if (count_ < 5)
+        {
+            heights_[count_++] = sample;
+            if (count_ == 5)
+            {
+                std::sort(heights_.begin(), heights_.end());
+            }
+            return;
+        }
+        count_++;
+
+        // Find the cell the sample falls into, extending the extremes if needed
+        int cell;
+        if (sample < heights_[0])
+        {
+            heights_[0] = sample;
+            cell = 0;
+        }
+        else if (sample >= heights_[4])
+        {
+            heights_[4] = sample;
+            cell = 3;
+        }
+        else
+        {
+            cell = 0;
+            while (cell < 3 && sample >= heights_[cell + 1])
+            {
+                cell++;
+            }
+        }
+
+        for (int i = cell + 1; i < 5; i++)
+        {
+            positions_[i] += 1.0;
+        }
+        for (int i = 0; i < 5; i++)
+        {
+            desired_[i] += increments_[i];
+        }
+
+        // Move the three middle markers towards their desired positions
+        for (int i = 1; i <= 3; i++)
+        {
+            double d = desired_[i] - positions_[i];
+            if ((d >= 1.0 && positions_[i + 1] - positions_[i] > 1.0) ||
+                (d <= -1.0 && positions_[i - 1] - positions_[i] < -1.0))
+            {
+                int step = d > 0.0 ? 1 : -1;
+                double candidate = parabolic(i, step);
+                if (heights_[i - 1] < candidate && candidate < heights_[i + 1])
+                {
+                    heights_[i] = candidate;
+                }
+                else
+                {
+                    heights_[i] = linear(i, step);
+                }
+                positions_[i] += step;
+            }
+        }
+    }
+
+    double P2Quantile::parabolic(int i, double d) const
+    {
+        return heights_[i] + d / (positions_[i + 1] - positions_[i - 1]) *
+                                 ((positions_[i] - positions_[i - 1] + d) * (heights_[i + 1] - heights_[i]) /
+                                      (positions_[i + 1] - positions_[i]) +
+                                  (positions_[i + 1] - positions_[i] - d) * (heights_[i] - heights_[i - 1]) /
+                                      (positions_[i] - positions_[i - 1]));
+    }
+
+    double P2Quantile::linear(int i, int d) const
+    {
+        return heights_[i] + d * (heights_[i + d] - heights_[i]) / (positions_[i + d] - positions_[i]);
+    }
+
+    double P2Quantile::value() const
+    {
+        if (count_ == 0)
+        {
+            return 0.0;
+        }
+
+        // Not enough samples for the markers yet: use the exact quantile
+        if (count_ < 5)
+        {
+            std::array<double, 5> sorted = heights_;
+            std::sort(sorted.begin(), sorted.begin() + count_);
+            auto index = static_cast<std::size_t>(probability_ * (count_ - 1) + 0.5);
+            return sorted[index];
+        }
+
+        return heights_[2];
+    }
+
+    // GumbelFit Implementation
+    GumbelFit::GumbelFit(std::size_t block_size)
+        : block_size_(std::max<std::size_t>(block_size, 1))
+    {
+    }
+
+    void GumbelFit::reset()
+    {
+        block_fill_ = 0;
+        block_max_ = 0.0;
+        blocks_ = 0;
+        mean_ = 0.0;
+        m2_ = 0.0;
+    }
+
+    void GumbelFit::add(double sample)
+    {
+        block_max_ = block_fill_ == 0 ? sample : std::max(block_max_, sample);
+        if (++block_fill_ < block_size_)
+        {
+            return;
+        }
+
+        // Block complete: fold its maximum into the running moments
+        blocks_++;
+        double delta = block_max_ - mean_;
+        mean_ += delta / blocks_;
+        m2_ += delta * (block_max_ - mean_);
+        block_fill_ = 0;
+    }
+
+    double GumbelFit::scale() const
+    {
+        if (!isValid())
+        {
+            return 0.0;
+        }
+
+        // Method of moments: variance = (pi * beta)^2 / 6
+        double stddev = std::sqrt(m2_ / (blocks_ - 1));
+        return stddev * std::sqrt(6.0) / PI;
+    }
+
+    double GumbelFit::location() const
+    {
+        return mean_ - EULER_GAMMA * scale();
+    }
+
+    double GumbelFit::quantile(double exceedance_probability) const
+    {
+        if (!isValid())
+        {
+            return 0.0;
+        }
+
+        // The fit describes block maxima; a per-sample exceedance p becomes
+        // roughly block_size * p for the maximum of a block
+        double block_exceedance = std::clamp(exceedance_probability * block_size_, 1e-15, 1.0 - 1e-15);
+        return location() - scale() * std::log(-std::log(1.0 - block_exceedance));
+    }
+
+    // WcetEstimator Implementation
+    WcetEstimator::WcetEstimator() = default;
+
+    void WcetEstimator::addSample(std::chrono::microseconds execution_time)
+    {
+        double sample = static_cast<double>(execution_time.count());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        p50_.add(sample);
+        p90_.add(sample);
+        p99_.add(sample);
+        gumbel_.add(sample);
+        max_ = samples_ == 0 ? sample : std::max(max_, sample);
+        samples_++;
+    }
+
+    void WcetEstimator::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        p50_.reset();
+        p90_.reset();
+        p99_.reset();
+        gumbel_.reset();
+        samples_ = 0;
+        max_ = 0.0;
+    }
+
+    WcetEstimate WcetEstimator::getEstimate(double exceedance_probability) const
+    {
+        auto to_us = [](double value)
+        {
+            return std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(std::ceil(value)));
+        };
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        WcetEstimate estimate;
+        estimate.samples = samples_;
+        estimate.observed_max = to_us(max_);
+        estimate.p50 = to_us(p50_.value());
+        estimate.p90 = to_us(p90_.value());
+        estimate.p99 = to_us(p99_.value());
+        estimate.exceedance_probability = exceedance_probability;
+        estimate.probabilistic_wcet = estimate.observed_max;
+
+        if (gumbel_.isValid())
+        {
+            estimate.gumbel_location_us = gumbel_.location();
+            estimate.gumbel_scale_us = gumbel_.scale();
+
+            // Never report a bound below what has already been observed
+            estimate.probabilistic_wcet = std::max(estimate.observed_max,
+                                                   to_us(gumbel_.quantile(exceedance_probability)));
+        }
+
+        return estimate;
+    }
+
+} // namespace edurtos
@@ -26,6 +26,7 @@ namespace edurtos
         {
             if (!is_running_.exchange(true))
             {
+                subscription_ = scheduler_.getEventBus().subscribe();
                 dashboard_thread_ = std::thread(&ConsoleDashboard::dashboardLoop, this);
             }
         }
@@ -38,6 +39,9 @@ namespace edurtos
                 {
                     dashboard_thread_.join();
                 }
+
+                scheduler_.getEventBus().unsubscribe(subscription_);
+                subscription_.reset();
             }
         }
 
@@ -70,19 +74,24 @@ namespace edurtos
         {
             std::lock_guard<std::mutex> lock(dashboard_mutex_);
 
+            // Every section renders from the same snapshot
+            auto snapshot = scheduler_.snapshot();
+
             clearConsole();
             renderHeader();
-            renderTaskList();
+            renderTaskList(*snapshot);
 
             if (show_task_details_)
             {
-                renderTaskDetails();
+                renderTaskDetails(*snapshot);
             }
 
             if (show_cpu_utilization_)
             {
-                renderCpuUtilization();
+                renderCpuUtilization(*snapshot);
             }
+
+            renderTransitions(*snapshot);
         }
 
         void ConsoleDashboard::dashboardLoop()
@@ -90,7 +99,11 @@ namespace edurtos
             while (is_running_)
             {
                 refresh();
+
+                // At most one redraw per refresh period, and none while no
+                // task changes state
                 std::this_thread::sleep_for(refresh_rate_);
+                subscription_->waitForEvents(IDLE_REFRESH);
             }
         }
 
@@ -219,10 +232,9 @@ namespace edurtos
             std::cout << "\n\n";
         }
 
-        void ConsoleDashboard::renderTaskList()
+        void ConsoleDashboard::renderTaskList(const SchedulerSnapshot &snapshot)
         {
-            auto &tasks = scheduler_.getAllTasks();
-            auto current_task = scheduler_.getCurrentTask();
+            const TaskSnapshot *current_task = snapshot.getCurrentTask();
 
             // Column headers
             setConsoleColor(ConsoleColor::WHITE);
@@ -244,55 +256,30 @@ namespace edurtos
             std::cout << std::string(60, '-') << "\n";
 
             // Task list
-            for (const auto &task : tasks)
+            for (const auto &task : snapshot.tasks)
             {
                 // Set color based on task state
-                setConsoleColor(getColorForTaskState(task->getState()));
+                setConsoleColor(getColorForTaskState(task.state));
 
                 // Highlight current task with a different background
-                if (task == current_task)
+                if (&task == current_task)
                 {
                     setConsoleColor(ConsoleColor::BLACK, ConsoleColor::LIGHT_GRAY);
                 }
 
                 // Print task info
                 std::cout << std::left
-                          << std::setw(20) << task->getName()
-                          << std::setw(10) << static_cast<int>(task->getDynamicPriority())
-                          << std::setw(10);
-
-                // Print state name
-                switch (task->getState())
-                {
-                case TaskState::RUNNING:
-                    std::cout << "RUNNING";
-                    break;
-                case TaskState::READY:
-                    std::cout << "READY";
-                    break;
-                case TaskState::BLOCKED:
-                    std::cout << "BLOCKED";
-                    break;
-                case TaskState::SUSPENDED:
-                    std::cout << "SUSPENDED";
-                    break;
-                case TaskState::TERMINATED:
-                    std::cout << "TERMINATED";
-                    break;
-                default:
-                    std::cout << "UNKNOWN";
-                    break;
-                }
+                          << std::setw(20) << task.name
+                          << std::setw(10) << static_cast<int>(task.dynamic_priority)
+                          << std::setw(10) << taskStateName(task.state);
 
                 // Print deadline info
-                std::cout << std::setw(10) << task->getDeadline().count();
+                std::cout << std::setw(10) << task.deadline.count();
 
                 // Show deadline percentage if enabled
-                if (show_deadlines_ && task->getDeadline().count() > 0)
+                if (show_deadlines_ && task.deadline.count() > 0)
                 {
-                    float deadline_percentage = 100.0f *
-                                                task->getStatistics().deadline_counter.count() /
-                                                task->getDeadline().count();
+                    float deadline_percentage = task.deadline_percent;
 
                     std::cout << std::setw(5) << std::fixed << std::setprecision(1) << deadline_percentage << "% ";
 
@@ -309,9 +296,9 @@ namespace edurtos
             std::cout << "\n";
         }
 
-        void ConsoleDashboard::renderTaskDetails()
+        void ConsoleDashboard::renderTaskDetails(const SchedulerSnapshot &snapshot)
         {
-            auto current_task = scheduler_.getCurrentTask();
+            const TaskSnapshot *current_task = snapshot.getCurrentTask();
 
             std::cout << "Task Details:\n";
             std::cout << "-----------------\n";
@@ -319,13 +306,14 @@ namespace edurtos
             if (current_task)
             {
                 setConsoleColor(ConsoleColor::GREEN);
-                std::cout << "Current Task: " << current_task->getName() << "\n";
+                std::cout << "Current Task: " << current_task->name << "\n";
                 resetConsoleColor();
 
-                auto &stats = current_task->getStatistics();
+                const auto &stats = current_task->statistics;
                 std::cout << "Executions: " << stats.execution_count << "\n";
                 std::cout << "Deadline Misses: " << stats.deadline_misses << "\n";
                 std::cout << "Average Execution Time: " << std::fixed << std::setprecision(2) << (stats.average_execution_time.count() / 1000.0) << " ms\n";
+                std::cout << "Average CPU Time: " << std::fixed << std::setprecision(2) << (stats.average_cpu_time.count() / 1000.0) << " ms\n";
             }
             else
             {
@@ -337,11 +325,12 @@ namespace edurtos
             std::cout << "\n";
         }
 
-        void ConsoleDashboard::renderCpuUtilization()
+        void ConsoleDashboard::renderCpuUtilization(const SchedulerSnapshot &snapshot)
         {
-            float utilization = scheduler_.getCpuUtilization();
+            float utilization = snapshot.cpu_utilization;
 
             std::cout << "CPU Utilization: " << std::fixed << std::setprecision(1) << utilization << "%\n";
+            std::cout << "Dispatcher Occupancy: " << std::fixed << std::setprecision(1) << snapshot.occupancy << "%\n";
 
             if (show_progress_bars_)
             {
@@ -366,6 +355,42 @@ namespace edurtos
             std::cout << "\n";
         }
 
+        void ConsoleDashboard::renderTransitions(const SchedulerSnapshot &snapshot)
+        {
+            if (!subscription_)
+            {
+                return;
+            }
+
+            // Keep only the newest transitions
+            std::vector<TaskEvent> events;
+            subscription_->poll(events);
+            for (const auto &event : events)
+            {
+                recent_transitions_.push_back(event);
+                if (recent_transitions_.size() > RECENT_TRANSITIONS)
+                {
+                    recent_transitions_.pop_front();
+                }
+            }
+
+            std::cout << "Recent Transitions";
+            if (subscription_->getDroppedCount() > 0)
+            {
+                std::cout << " (" << subscription_->getDroppedCount() << " dropped)";
+            }
+            std::cout << ":\n";
+
+            for (const auto &event : recent_transitions_)
+            {
+                const TaskSnapshot *task = snapshot.findTask(event.task_id);
+                std::cout << "  " << std::left << std::setw(20) << (task ? task->name : "task#" + std::to_string(event.task_id))
+                          << taskStateName(event.from) << " -> " << taskStateName(event.to) << "\n";
+            }
+
+            std::cout << "\n";
+        }
+
         std::string ConsoleDashboard::generateProgressBar(float percentage, int width,
                                                           const std::string &fill_char,
                                                           const std::string &empty_char)
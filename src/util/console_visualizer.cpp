@@ -1,4 +1,5 @@
 #include "../../include/util/console_visualizer.hpp"
+#include "../../include/kernel/scheduler.hpp"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -13,6 +14,14 @@ namespace edurtos
         {
         }
 
+        ConsoleVisualizer::~ConsoleVisualizer()
+        {
+            if (scheduler_ && subscription_)
+            {
+                scheduler_->getEventBus().unsubscribe(subscription_);
+            }
+        }
+
         void ConsoleVisualizer::setDisplayMode(DisplayMode mode)
         {
             mode_ = mode;
@@ -58,6 +67,56 @@ namespace edurtos
             }
         }
 
+        void ConsoleVisualizer::attachScheduler(Scheduler &scheduler)
+        {
+            if (scheduler_ && subscription_)
+            {
+                scheduler_->getEventBus().unsubscribe(subscription_);
+            }
+
+            scheduler_ = &scheduler;
+            subscription_ = scheduler.getEventBus().subscribe();
+        }
+
+        void ConsoleVisualizer::drainEvents()
+        {
+            if (!subscription_)
+            {
+                return;
+            }
+
+            std::vector<TaskEvent> events;
+            subscription_->poll(events);
+            for (const auto &event : events)
+            {
+                for (const auto &[task, symbol] : task_symbols_)
+                {
+                    if (task->getId() == event.task_id)
+                    {
+                        recordTaskStateChange(task, event.from, event.to, event.getTimestamp());
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::shared_ptr<const SchedulerSnapshot> ConsoleVisualizer::takeSnapshot() const
+        {
+            if (scheduler_)
+            {
+                return scheduler_->snapshot();
+            }
+
+            // Standalone: capture the registered tasks once per frame
+            auto snapshot = std::make_shared<SchedulerSnapshot>();
+            snapshot->timestamp = std::chrono::steady_clock::now();
+            for (const auto &[task, symbol] : task_symbols_)
+            {
+                snapshot->tasks.push_back(TaskSnapshot::capture(*task, symbol));
+            }
+            return snapshot;
+        }
+
         char ConsoleVisualizer::getDefaultSymbol(size_t index) const
         {
             static const std::string symbols = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
@@ -121,10 +180,11 @@ namespace edurtos
             return ss.str();
         }
 
-        void ConsoleVisualizer::recordTaskStateChange(TaskPtr task, TaskState previous, TaskState current)
+        void ConsoleVisualizer::recordTaskStateChange(TaskPtr task, TaskState previous, TaskState current,
+                                                      std::chrono::steady_clock::time_point timestamp)
         {
             TimelineEvent event;
-            event.timestamp = std::chrono::steady_clock::now();
+            event.timestamp = timestamp;
             event.task = task;
             event.previous_state = previous;
             event.new_state = current;
@@ -133,12 +193,13 @@ namespace edurtos
             // Limit timeline size to prevent excessive memory usage
             if (timeline_events_.size() > 1000)
             {
-                timeline_events_.erase(timeline_events_.begin());
+                timeline_events_.pop_front();
             }
         }
 
         std::string ConsoleVisualizer::generateTaskStateVisualization()
         {
+            auto snapshot = takeSnapshot();
             std::stringstream ss;
 
             // Header row with task symbols
@@ -161,7 +222,8 @@ namespace edurtos
             ss << "now  | ";
             for (const auto &[task, symbol] : task_symbols_)
             {
-                ss << getTaskStateChar(task->getState()) << " ";
+                const TaskSnapshot *state = snapshot->findTask(task.get());
+                ss << (state ? getTaskStateChar(state->state) : "?") << " ";
             }
             ss << "| ";
 
@@ -174,22 +236,24 @@ namespace edurtos
                 first = false;
                 ss << symbol << ":" << task->getName();
 
-                if (show_priorities_)
+                const TaskSnapshot *state = snapshot->findTask(task.get());
+                if (!state)
                 {
-                    ss << "(" << static_cast<int>(task->getDynamicPriority()) << ")";
+                    continue;
                 }
 
-                if (show_deadlines_ && task->getDeadline().count() > 0)
+                if (show_priorities_)
                 {
-                    float deadline_percentage = 100.0f *
-                                                task->getStatistics().deadline_counter.count() /
-                                                task->getDeadline().count();
+                    ss << "(" << static_cast<int>(state->dynamic_priority) << ")";
+                }
 
-                    ss << " " << std::fixed << std::setprecision(1) << deadline_percentage << "%";
+                if (show_deadlines_ && state->deadline.count() > 0)
+                {
+                    ss << " " << std::fixed << std::setprecision(1) << state->deadline_percent << "%";
 
-                    if (task->getStatistics().deadline_misses > 0)
+                    if (state->statistics.deadline_misses > 0)
                     {
-                        ss << " [" << task->getStatistics().deadline_misses << " misses]";
+                        ss << " [" << state->statistics.deadline_misses << " misses]";
                     }
                 }
             }
@@ -199,6 +263,8 @@ namespace edurtos
 
         std::string ConsoleVisualizer::generateTaskTimelineVisualization(std::chrono::seconds duration)
         {
+            drainEvents();
+
             // Filter events within the specified duration
             auto now = std::chrono::steady_clock::now();
             auto cutoff = now - duration;
@@ -256,6 +322,7 @@ namespace edurtos
 
         std::string ConsoleVisualizer::generateTaskMetricsVisualization()
         {
+            auto snapshot = takeSnapshot();
             std::stringstream ss;
             ss << "Task Metrics:\n";
             ss << "+-" << std::string(20, '-') << "-+-" << std::string(8, '-') << "-+-"
@@ -274,21 +341,19 @@ namespace edurtos
 
             for (const auto &[task, symbol] : task_symbols_)
             {
-                float deadline_percentage = 0.0f;
-                if (task->getDeadline().count() > 0)
+                const TaskSnapshot *state = snapshot->findTask(task.get());
+                if (!state)
                 {
-                    deadline_percentage = 100.0f *
-                                          task->getStatistics().deadline_counter.count() /
-                                          task->getDeadline().count();
+                    continue;
                 }
 
-                ss << "| " << std::left << std::setw(20) << task->getName() << " | "
-                   << std::right << std::setw(8) << static_cast<int>(task->getDynamicPriority()) << " | "
-                   << std::setw(10) << task->getStatistics().execution_count << " | ";
+                ss << "| " << std::left << std::setw(20) << state->name << " | "
+                   << std::right << std::setw(8) << static_cast<int>(state->dynamic_priority) << " | "
+                   << std::setw(10) << state->statistics.execution_count << " | ";
 
-                if (task->getDeadline().count() > 0)
+                if (state->deadline.count() > 0)
                 {
-                    ss << std::setw(10) << std::fixed << std::setprecision(1) << deadline_percentage << "% | ";
+                    ss << std::setw(10) << std::fixed << std::setprecision(1) << state->deadline_percent << "% | ";
                 }
                 else
                 {
@@ -296,7 +361,7 @@ namespace edurtos
                 }
 
                 ss << std::setw(12) << std::fixed << std::setprecision(2)
-                   << task->getStatistics().average_execution_time.count() / 1000.0 << " |\n";
+                   << state->statistics.average_execution_time.count() / 1000.0 << " |\n";
             }
 
             ss << "+-" << std::string(20, '-') << "-+-" << std::string(8, '-') << "-+-"
@@ -314,6 +379,7 @@ namespace edurtos
                 return;
             }
             last_refresh_ = now;
+            drainEvents();
 
 // Clear screen (cross-platform)
 #ifdef _WIN32
@@ -343,10 +409,17 @@ namespace edurtos
                           << "Task Priority Chart:\n";
 
                 // Display ASCII bar chart of task priorities
+                auto snapshot = takeSnapshot();
                 for (const auto &[task, symbol] : task_symbols_)
                 {
-                    float priority_percentage = task->getDynamicPriority() * 100.0f / 99.0f;
-                    std::cout << std::left << std::setw(15) << task->getName() << " "
+                    const TaskSnapshot *state = snapshot->findTask(task.get());
+                    if (!state)
+                    {
+                        continue;
+                    }
+
+                    float priority_percentage = state->dynamic_priority * 100.0f / 99.0f;
+                    std::cout << std::left << std::setw(15) << state->name << " "
                               << generateProgressBar(priority_percentage, 30) << "\n";
                 }
                 break;
@@ -1,4 +1,5 @@
 #include "../../include/util/fault_injector.hpp"
+#include "../../include/util/trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
@@ -200,6 +201,8 @@ namespace edurtos
                 }
             }
 
+            EDURTOS_TRACE(FAULT, fault_injector, inject, type, target_task.get());
+
             std::cout << "Injecting fault: ";
             switch (type)
             {
@@ -437,6 +440,7 @@ namespace edurtos
 
         void FaultInjector::handleSegmentationFault(int signal)
         {
+            EDURTOS_TRACE(FAULT, fault_injector, segv, signal, thread_context_.in_protected_region);
             std::cerr << "Caught segmentation fault (SIGSEGV)" << std::endl;
 
             // Check if we're in a protected region and have a task
@@ -0,0 +1,164 @@
+#include "../../include/util/harmonic_periods.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <sstream>
+
+namespace edurtos
+{
+    namespace util
+    {
+        namespace
+        {
+            using Rep = std::chrono::microseconds::rep;
+
+            // Least common multiple, saturating at the largest duration
+            Rep saturatingLcm(Rep a, Rep b)
+            {
+                Rep step = a / std::gcd(a, b);
+                if (step > std::numeric_limits<Rep>::max() / b)
+                {
+                    return std::numeric_limits<Rep>::max();
+                }
+                return step * b;
+            }
+
+            // Longest base * 2^k not above `period`
+            Rep harmonicPeriod(Rep base, Rep period)
+            {
+                Rep harmonic = base;
+                while (harmonic <= period / 2)
+                {
+                    harmonic *= 2;
+                }
+                return harmonic;
+            }
+
+            double utilization(const std::vector<PeriodRequirement> &requirements, Rep base)
+            {
+                double total = 0.0;
+                for (const auto &requirement : requirements)
+                {
+                    total += static_cast<double>(requirement.wcet.count()) /
+                             harmonicPeriod(base, requirement.period.count()) * 100.0;
+                }
+                return total;
+            }
+        }
+
+        PeriodRequirement PeriodRequirement::fromTask(const Task &task)
+        {
+            PeriodRequirement requirement;
+            requirement.name = task.getName();
+            requirement.period = task.getPeriod();
+
+            WcetEstimate estimate = task.getWcetEstimate();
+            requirement.wcet = estimate.samples > 0 ? estimate.probabilistic_wcet
+                                                    : task.getStatistics().average_execution_time;
+            return requirement;
+        }
+
+        HarmonicPlan suggestHarmonicPeriods(const std::vector<PeriodRequirement> &requirements,
+                                            std::chrono::microseconds granularity)
+        {
+            HarmonicPlan plan;
+
+            std::vector<PeriodRequirement> periodic;
+            std::copy_if(requirements.begin(), requirements.end(), std::back_inserter(periodic),
+                         [](const PeriodRequirement &requirement)
+                         { return requirement.period.count() > 0; });
+            if (periodic.empty())
+            {
+                return plan;
+            }
+
+            Rep grain = std::max<Rep>(granularity.count(), 1);
+            Rep shortest = std::min_element(periodic.begin(), periodic.end(),
+                                            [](const PeriodRequirement &a, const PeriodRequirement &b)
+                                            { return a.period < b.period; })
+                               ->period.count();
+
+            // Candidate bases: every period halved down into (shortest / 2, shortest].
+            // Before rounding to the granularity the best base is always one of
+            // them, as with any other base no task keeps its period.
+            Rep best_base = 0;
+            double best_utilization = std::numeric_limits<double>::max();
+            for (const auto &requirement : periodic)
+            {
+                Rep base = requirement.period.count();
+                while (base > shortest)
+                {
+                    base /= 2;
+                }
+                base = base / grain * grain;
+                if (base == 0)
+                {
+                    continue;
+                }
+
+                double candidate = utilization(periodic, base);
+                if (candidate < best_utilization || (candidate == best_utilization && base > best_base))
+                {
+                    best_base = base;
+                    best_utilization = candidate;
+                }
+            }
+
+            // Every period is shorter than the granularity
+            if (best_base == 0)
+            {
+                best_base = grain;
+                best_utilization = utilization(periodic, best_base);
+            }
+
+            Rep hyperperiod = 1;
+            Rep longest = 0;
+            std::set<Rep> distinct;
+            for (const auto &requirement : periodic)
+            {
+                Rep suggested = harmonicPeriod(best_base, requirement.period.count());
+                plan.tasks.push_back({requirement.name, requirement.period, std::chrono::microseconds(suggested)});
+                plan.utilization += static_cast<double>(requirement.wcet.count()) / requirement.period.count() * 100.0;
+
+                hyperperiod = saturatingLcm(hyperperiod, requirement.period.count());
+                longest = std::max(longest, suggested);
+                distinct.insert(suggested);
+            }
+
+            plan.base_period = std::chrono::microseconds(best_base);
+            plan.hyperperiod = std::chrono::microseconds(hyperperiod);
+            plan.suggested_hyperperiod = std::chrono::microseconds(longest);
+            plan.suggested_utilization = best_utilization;
+            plan.release_groups = distinct.size();
+            return plan;
+        }
+
+        std::string formatHarmonicPlan(const HarmonicPlan &plan)
+        {
+            std::ostringstream out;
+            out << std::left << std::setw(20) << "Task"
+                << std::right << std::setw(14) << "Period (us)"
+                << std::setw(16) << "Suggested (us)" << "\n";
+            for (const auto &task : plan.tasks)
+            {
+                out << std::left << std::setw(20) << task.name
+                    << std::right << std::setw(14) << task.period.count()
+                    << std::setw(16) << task.suggested.count()
+                    << (task.suggested != task.period ? "  *" : "") << "\n";
+            }
+
+            out << std::fixed << std::setprecision(1)
+                << "Base period: " << plan.base_period.count() << " us, "
+                << plan.release_groups << " release groups\n"
+                << "Hyperperiod: " << plan.hyperperiod.count() << " us -> "
+                << plan.suggested_hyperperiod.count() << " us\n"
+                << "Utilization: " << plan.utilization << "% -> "
+                << plan.suggested_utilization << "%"
+                << (plan.schedulable() ? "" : " (not schedulable)") << "\n";
+            return out.str();
+        }
+
+    } // namespace util
+} // namespace edurtos
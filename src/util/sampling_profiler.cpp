@@ -0,0 +1,403 @@
+#include "../../include/util/sampling_profiler.hpp"
+#include "../../include/kernel/task.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <dlfcn.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#endif
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        SamplingProfiler &SamplingProfiler::getInstance()
+        {
+            static SamplingProfiler instance;
+            return instance;
+        }
+
+        SamplingProfiler::SamplingProfiler() = default;
+
+        SamplingProfiler::~SamplingProfiler()
+        {
+            stop();
+        }
+
+#ifdef _WIN32
+        bool SamplingProfiler::start(const ProfilerConfig &)
+        {
+            std::cerr << "Error: Sampling profiler requires SIGPROF and is not available on Windows" << std::endl;
+            return false;
+        }
+
+        void SamplingProfiler::stop()
+        {
+        }
+
+        void SamplingProfiler::handleSignal(void *)
+        {
+        }
+
+        void SamplingProfiler::recordSample(void *)
+        {
+        }
+#else
+        namespace
+        {
+            std::uint64_t monotonicNs()
+            {
+                timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+            }
+
+            // Program counter, frame pointer and stack pointer of the interrupted code
+            bool interruptedRegisters(void *ucontext, std::uintptr_t &pc, std::uintptr_t &fp, std::uintptr_t &sp)
+            {
+                auto *context = static_cast<ucontext_t *>(ucontext);
+#if defined(__linux__) && defined(__x86_64__)
+                pc = static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+                fp = static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+                sp = static_cast<std::uintptr_t>(context->uc_mcontext.gregs[REG_RSP]);
+                return true;
+#elif defined(__linux__) && defined(__aarch64__)
+                pc = static_cast<std::uintptr_t>(context->uc_mcontext.pc);
+                fp = static_cast<std::uintptr_t>(context->uc_mcontext.regs[29]);
+                sp = static_cast<std::uintptr_t>(context->uc_mcontext.sp);
+                return true;
+#else
+                (void)context;
+                pc = fp = sp = 0;
+                return false;
+#endif
+            }
+
+            // Frames further than this above the interrupted stack pointer are
+            // treated as corrupt rather than followed
+            constexpr std::uintptr_t MAX_STACK_SPAN = 8 * 1024 * 1024;
+        }
+
+        bool SamplingProfiler::start(const ProfilerConfig &config)
+        {
+            if (is_running_)
+            {
+                return true;
+            }
+            if (config.frequency_hz == 0 || config.frequency_hz > 10000)
+            {
+                std::cerr << "Error: Profiler frequency must be between 1 and 10000 Hz" << std::endl;
+                return false;
+            }
+
+            config_ = config;
+            config_.max_stack_depth = std::min(config_.max_stack_depth, MAX_STACK_DEPTH);
+            samples_ = std::make_unique<BoundedQueue<Sample>>(config_.buffer_size);
+
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_sigaction = [](int, siginfo_t *, void *ucontext)
+            {
+                handleSignal(ucontext);
+            };
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            if (sigaction(SIGPROF, &action, nullptr) != 0)
+            {
+                std::cerr << "Error: Could not install SIGPROF handler" << std::endl;
+                samples_.reset();
+                return false;
+            }
+
+            is_running_ = true;
+            collector_thread_ = std::thread(&SamplingProfiler::collectorLoop, this);
+
+            // ITIMER_PROF counts CPU time of the whole process, so idle time is
+            // not sampled and busy threads are sampled proportionally
+            itimerval timer;
+            std::memset(&timer, 0, sizeof(timer));
+            unsigned int interval_us = 1000000 / config_.frequency_hz;
+            timer.it_interval.tv_sec = static_cast<time_t>(interval_us / 1000000);
+            timer.it_interval.tv_usec = static_cast<suseconds_t>(interval_us % 1000000);
+            timer.it_value = timer.it_interval;
+            if (setitimer(ITIMER_PROF, &timer, nullptr) != 0)
+            {
+                std::cerr << "Error: Could not start profiling timer" << std::endl;
+                stop();
+                return false;
+            }
+
+            return true;
+        }
+
+        void SamplingProfiler::stop()
+        {
+            if (!is_running_.exchange(false))
+            {
+                return;
+            }
+
+            itimerval timer;
+            std::memset(&timer, 0, sizeof(timer));
+            setitimer(ITIMER_PROF, &timer, nullptr);
+
+            // A signal already in flight must not find the default action, which
+            // would terminate the process
+            signal(SIGPROF, SIG_IGN);
+
+            if (collector_thread_.joinable())
+            {
+                collector_thread_.join();
+            }
+            collect();
+        }
+
+        void SamplingProfiler::handleSignal(void *ucontext)
+        {
+            int saved_errno = errno;
+            getInstance().recordSample(ucontext);
+            errno = saved_errno;
+        }
+
+        void SamplingProfiler::recordSample(void *ucontext)
+        {
+            // Async-signal-safe only: no allocation, no locks, no stdio
+            BoundedQueue<Sample> *queue = samples_.get();
+            if (!is_running_.load(std::memory_order_relaxed) || queue == nullptr)
+            {
+                return;
+            }
+
+            std::uint64_t begin = monotonicNs();
+
+            Sample sample;
+            const Task *task = Task::current();
+            const char *name = task ? task->getName().c_str() : "[no task]";
+            std::size_t length = std::min(std::strlen(name), TASK_NAME_SIZE - 1);
+            std::memcpy(sample.task_name.data(), name, length);
+            sample.task_name[length] = '\0';
+
+            std::uintptr_t pc, fp, sp;
+            if (interruptedRegisters(ucontext, pc, fp, sp))
+            {
+                sample.stack[sample.depth++] = pc;
+
+                if (config_.capture_stacks)
+                {
+                    // Each frame starts with { saved frame pointer, return address }
+                    while (sample.depth < config_.max_stack_depth &&
+                           fp >= sp && fp < sp + MAX_STACK_SPAN &&
+                           (fp & (sizeof(std::uintptr_t) - 1)) == 0)
+                    {
+                        const auto *frame = reinterpret_cast<const std::uintptr_t *>(fp);
+                        std::uintptr_t next_fp = frame[0];
+                        std::uintptr_t return_address = frame[1];
+                        if (return_address == 0)
+                        {
+                            break;
+                        }
+
+                        // Return addresses point after the call; step back into it
+                        sample.stack[sample.depth++] = return_address - 1;
+
+                        // Stacks grow down, so callers live at higher addresses
+                        if (next_fp <= fp)
+                        {
+                            break;
+                        }
+                        fp = next_fp;
+                    }
+                }
+            }
+
+            if (!queue->tryPush(sample))
+            {
+                dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            std::uint64_t elapsed = monotonicNs() - begin;
+            handler_ns_total_.fetch_add(elapsed, std::memory_order_relaxed);
+            handler_calls_.fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t max = handler_ns_max_.load(std::memory_order_relaxed);
+            while (elapsed > max && !handler_ns_max_.compare_exchange_weak(max, elapsed, std::memory_order_relaxed))
+            {
+            }
+        }
+#endif
+
+        void SamplingProfiler::collectorLoop()
+        {
+            while (is_running_)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                collect();
+            }
+        }
+
+        void SamplingProfiler::collect()
+        {
+            if (!samples_)
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+
+            Sample sample;
+            while (samples_->tryPop(sample))
+            {
+                std::string task_name(sample.task_name.data());
+                flat_profile_[task_name]++;
+                collected_samples_++;
+
+                // Folded format lists the outermost frame first
+                std::string folded = task_name;
+                for (std::size_t i = sample.depth; i-- > 0;)
+                {
+                    folded += ';';
+                    folded += symbolize(sample.stack[i]);
+                }
+                folded_stacks_[folded]++;
+            }
+        }
+
+        const std::string &SamplingProfiler::symbolize(std::uintptr_t address)
+        {
+            auto it = symbol_cache_.find(address);
+            if (it != symbol_cache_.end())
+            {
+                return it->second;
+            }
+
+            std::string symbol;
+#ifndef _WIN32
+            // Only exported symbols resolve; link executables with -rdynamic
+            // for names from the main program
+            Dl_info info;
+            if (dladdr(reinterpret_cast<void *>(address), &info) != 0 && info.dli_sname != nullptr)
+            {
+                symbol = info.dli_sname;
+#if defined(__GNUC__)
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                if (status == 0 && demangled != nullptr)
+                {
+                    symbol = demangled;
+                }
+                std::free(demangled);
+#endif
+            }
+#endif
+            if (symbol.empty())
+            {
+                std::ostringstream hex;
+                hex << "0x" << std::hex << address;
+                symbol = hex.str();
+            }
+
+            // ';' separates frames in folded stacks
+            std::replace(symbol.begin(), symbol.end(), ';', ':');
+            return symbol_cache_.emplace(address, std::move(symbol)).first->second;
+        }
+
+        void SamplingProfiler::reset()
+        {
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+            collected_samples_ = 0;
+            flat_profile_.clear();
+            folded_stacks_.clear();
+            dropped_samples_ = 0;
+            handler_ns_total_ = 0;
+            handler_ns_max_ = 0;
+            handler_calls_ = 0;
+        }
+
+        std::map<std::string, std::uint64_t> SamplingProfiler::getFlatProfile()
+        {
+            collect();
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+            return flat_profile_;
+        }
+
+        ProfilerStatistics SamplingProfiler::getStatistics()
+        {
+            collect();
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+
+            ProfilerStatistics statistics;
+            statistics.samples = collected_samples_;
+            statistics.dropped_samples = dropped_samples_;
+            std::uint64_t calls = handler_calls_;
+            statistics.average_handler_ns = calls > 0 ? static_cast<double>(handler_ns_total_) / calls : 0.0;
+            statistics.max_handler_ns = handler_ns_max_;
+            return statistics;
+        }
+
+        bool SamplingProfiler::writeFlatProfile(const std::string &filename)
+        {
+            std::ofstream file(filename, std::ios::out | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "Error: Could not open profile file: " << filename << std::endl;
+                return false;
+            }
+
+            auto profile = getFlatProfile();
+            std::vector<std::pair<std::string, std::uint64_t>> rows(profile.begin(), profile.end());
+            std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b)
+                      { return a.second > b.second; });
+
+            std::uint64_t total = 0;
+            for (const auto &row : rows)
+            {
+                total += row.second;
+            }
+
+            file << "Task,Samples,Percent" << std::endl;
+            for (const auto &row : rows)
+            {
+                file << row.first << ","
+                     << row.second << ","
+                     << (total > 0 ? 100.0 * row.second / total : 0.0) << std::endl;
+            }
+
+            return true;
+        }
+
+        bool SamplingProfiler::writeFoldedStacks(const std::string &filename)
+        {
+            std::ofstream file(filename, std::ios::out | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "Error: Could not open profile file: " << filename << std::endl;
+                return false;
+            }
+
+            collect();
+            std::lock_guard<std::mutex> lock(profile_mutex_);
+            for (const auto &[stack, count] : folded_stacks_)
+            {
+                file << stack << " " << count << std::endl;
+            }
+
+            return true;
+        }
+
+    } // namespace util
+} // namespace edurtos
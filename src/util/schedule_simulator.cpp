@@ -0,0 +1,553 @@
+#include "../../include/util/schedule_simulator.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace edurtos
+{
+    namespace util
+    {
+        namespace
+        {
+            // Log-linear histogram of response times in microseconds: exact below
+            // 16 us, then 16 buckets per power of two (about 6% resolution).
+            // Fixed size, so per-run histograms merge by addition.
+            class ResponseHistogram
+            {
+            public:
+                static constexpr std::size_t SUB_BUCKETS = 16;
+                static constexpr std::size_t BUCKETS = SUB_BUCKETS + (64 - 4) * SUB_BUCKETS;
+
+                void add(std::uint64_t value)
+                {
+                    counts_[indexOf(value)]++;
+                    count_++;
+                    sum_ += value;
+                    max_ = std::max(max_, value);
+                }
+
+                void merge(const ResponseHistogram &other)
+                {
+                    for (std::size_t i = 0; i < BUCKETS; i++)
+                    {
+                        counts_[i] += other.counts_[i];
+                    }
+                    count_ += other.count_;
+                    sum_ += other.sum_;
+                    max_ = std::max(max_, other.max_);
+                }
+
+                std::uint64_t percentile(double fraction) const
+                {
+                    if (count_ == 0)
+                    {
+                        return 0;
+                    }
+
+                    auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count_ - 1)) + 1;
+                    std::uint64_t seen = 0;
+                    for (std::size_t i = 0; i < BUCKETS; i++)
+                    {
+                        seen += counts_[i];
+                        if (seen >= rank)
+                        {
+                            return std::min(upperBound(i), max_);
+                        }
+                    }
+                    return max_;
+                }
+
+                std::uint64_t mean() const { return count_ > 0 ? sum_ / count_ : 0; }
+                std::uint64_t max() const { return max_; }
+
+            private:
+                std::array<std::uint64_t, BUCKETS> counts_{};
+                std::uint64_t count_ = 0;
+                std::uint64_t sum_ = 0;
+                std::uint64_t max_ = 0;
+
+                static std::size_t indexOf(std::uint64_t value)
+                {
+                    if (value < SUB_BUCKETS)
+                    {
+                        return static_cast<std::size_t>(value);
+                    }
+                    std::size_t msb = std::bit_width(value) - 1;
+                    std::size_t sub = static_cast<std::size_t>(value >> (msb - 4)) & (SUB_BUCKETS - 1);
+                    return SUB_BUCKETS + (msb - 4) * SUB_BUCKETS + sub;
+                }
+
+                static std::uint64_t upperBound(std::size_t index)
+                {
+                    if (index < SUB_BUCKETS)
+                    {
+                        return index;
+                    }
+                    std::size_t msb = (index - SUB_BUCKETS) / SUB_BUCKETS + 4;
+                    std::uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+                    std::uint64_t width = std::uint64_t{1} << (msb - 4);
+                    return ((SUB_BUCKETS + sub) << (msb - 4)) + width - 1;
+                }
+            };
+
+            // Decorrelates consecutive seeds before they reach the generator
+            std::uint64_t splitmix64(std::uint64_t value)
+            {
+                value += 0x9E3779B97F4A7C15ull;
+                value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+                value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+                return value ^ (value >> 31);
+            }
+        }
+
+        struct ScheduleSimulator::RunResult
+        {
+            struct TaskCounters
+            {
+                std::uint64_t jobs = 0;
+                std::uint64_t misses = 0;
+                std::uint64_t faults = 0;
+                ResponseHistogram response;
+            };
+
+            std::vector<TaskCounters> tasks;
+            std::uint64_t interrupts = 0;
+            std::uint64_t busy_us = 0;
+        };
+
+        // ExecutionTimeDistribution
+
+        ExecutionTimeDistribution ExecutionTimeDistribution::constant(std::chrono::microseconds execution_time)
+        {
+            ExecutionTimeDistribution distribution;
+            distribution.kind_ = Kind::CONSTANT;
+            distribution.samples_.push_back(execution_time);
+            return distribution;
+        }
+
+        ExecutionTimeDistribution ExecutionTimeDistribution::fromSamples(std::vector<std::chrono::microseconds> samples)
+        {
+            if (samples.empty())
+            {
+                return constant(std::chrono::microseconds(0));
+            }
+
+            ExecutionTimeDistribution distribution;
+            distribution.kind_ = Kind::EMPIRICAL;
+            distribution.samples_ = std::move(samples);
+            return distribution;
+        }
+
+        ExecutionTimeDistribution ExecutionTimeDistribution::fromEstimate(const WcetEstimate &estimate)
+        {
+            if (estimate.samples == 0)
+            {
+                return constant(std::chrono::microseconds(0));
+            }
+
+            auto p50 = static_cast<double>(estimate.p50.count());
+            auto p90 = std::max(p50, static_cast<double>(estimate.p90.count()));
+            auto p99 = std::max(p90, static_cast<double>(estimate.p99.count()));
+            auto observed_max = std::max(p99, static_cast<double>(estimate.observed_max.count()));
+            auto bound = std::max(observed_max, static_cast<double>(estimate.probabilistic_wcet.count()));
+
+            // Mirror the upper half for the lower tail; the exact shape below the
+            // median hardly affects deadline misses
+            double lowest = std::max(0.0, p50 - (p90 - p50));
+
+            // The observed maximum sits at the 1 - 1/n quantile, the probabilistic
+            // bound at its exceedance probability
+            double max_quantile = std::max(0.99, 1.0 - 1.0 / static_cast<double>(estimate.samples));
+            double bound_quantile = estimate.exceedance_probability > 0.0
+                                        ? std::max(max_quantile, 1.0 - estimate.exceedance_probability)
+                                        : 1.0;
+
+            ExecutionTimeDistribution distribution;
+            distribution.kind_ = Kind::QUANTILES;
+            distribution.quantiles_ = {
+                {0.0, lowest},
+                {0.5, p50},
+                {0.9, p90},
+                {0.99, p99},
+                {max_quantile, observed_max},
+                {bound_quantile, bound},
+                {1.0, bound}};
+            return distribution;
+        }
+
+        std::chrono::microseconds ExecutionTimeDistribution::sample(std::mt19937_64 &rng) const
+        {
+            switch (kind_)
+            {
+            case Kind::CONSTANT:
+                return samples_.empty() ? std::chrono::microseconds(0) : samples_.front();
+
+            case Kind::EMPIRICAL:
+            {
+                std::uniform_int_distribution<std::size_t> index(0, samples_.size() - 1);
+                return samples_[index(rng)];
+            }
+
+            case Kind::QUANTILES:
+            {
+                double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+                for (std::size_t i = 1; i < quantiles_.size(); i++)
+                {
+                    const auto &[p0, v0] = quantiles_[i - 1];
+                    const auto &[p1, v1] = quantiles_[i];
+                    if (u <= p1)
+                    {
+                        double t = p1 > p0 ? (u - p0) / (p1 - p0) : 1.0;
+                        return std::chrono::microseconds(static_cast<std::int64_t>(v0 + t * (v1 - v0)));
+                    }
+                }
+                return std::chrono::microseconds(static_cast<std::int64_t>(quantiles_.back().second));
+            }
+            }
+            return std::chrono::microseconds(0);
+        }
+
+        // SimulatedTask
+
+        SimulatedTask SimulatedTask::fromTask(const Task &task)
+        {
+            SimulatedTask simulated;
+            simulated.name = task.getName();
+            simulated.priority = task.getBasePriority();
+            simulated.period = task.getPeriod();
+            simulated.deadline = task.getDeadline();
+
+            WcetEstimate estimate = task.getWcetEstimate();
+            simulated.execution_time = estimate.samples > 0
+                                           ? ExecutionTimeDistribution::fromEstimate(estimate)
+                                           : ExecutionTimeDistribution::constant(task.getStatistics().average_execution_time);
+            return simulated;
+        }
+
+        // ScheduleSimulator
+
+        ScheduleSimulator::ScheduleSimulator(SimulationConfig config)
+            : config_(std::move(config))
+        {
+        }
+
+        bool ScheduleSimulator::addTask(const SimulatedTask &task)
+        {
+            if (task.period.count() <= 0)
+            {
+                std::cerr << "Error: Simulated task " << task.name << " needs a period" << std::endl;
+                return false;
+            }
+
+            tasks_.push_back(task);
+            return true;
+        }
+
+        void ScheduleSimulator::clearTasks()
+        {
+            tasks_.clear();
+        }
+
+        void ScheduleSimulator::setConfig(const SimulationConfig &config)
+        {
+            config_ = config;
+        }
+
+        ScheduleSimulator::RunResult ScheduleSimulator::simulateRun(std::size_t run_index) const
+        {
+            std::mt19937_64 rng(splitmix64(config_.seed + run_index));
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            std::exponential_distribution<double> interarrival(config_.interrupt_rate_hz > 0.0 ? config_.interrupt_rate_hz / 1e6 : 1.0);
+
+            const std::int64_t end = config_.duration.count();
+            constexpr std::int64_t NEVER = std::numeric_limits<std::int64_t>::max();
+
+            RunResult result;
+            result.tasks.resize(tasks_.size());
+
+            std::vector<std::int64_t> next_release(tasks_.size());
+            std::vector<std::deque<std::int64_t>> pending(tasks_.size()); // Release times of waiting jobs
+            for (std::size_t i = 0; i < tasks_.size(); i++)
+            {
+                next_release[i] = tasks_[i].offset.count();
+            }
+
+            auto deadlineOf = [this](std::size_t i)
+            {
+                return tasks_[i].deadline.count() > 0 ? tasks_[i].deadline.count() : tasks_[i].period.count();
+            };
+
+            std::int64_t next_interrupt = config_.interrupt_rate_hz > 0.0
+                                              ? static_cast<std::int64_t>(interarrival(rng))
+                                              : NEVER;
+
+            auto interruptServiceTime = [this](std::mt19937_64 &generator)
+            {
+                return std::max<std::int64_t>(0, config_.interrupt_service_time.sample(generator).count());
+            };
+
+            // Serve interrupts arriving before `until`, starting no earlier than
+            // `busy_until`; returns when the processor is free again
+            auto serviceInterrupts = [&](std::int64_t busy_until, std::int64_t until)
+            {
+                while (next_interrupt < until && next_interrupt < end)
+                {
+                    std::int64_t service = interruptServiceTime(rng);
+                    busy_until = std::max(busy_until, next_interrupt) + service;
+                    result.busy_us += service;
+                    result.interrupts++;
+                    next_interrupt += std::max<std::int64_t>(1, static_cast<std::int64_t>(interarrival(rng)));
+                }
+                return busy_until;
+            };
+
+            std::int64_t now = 0;
+            while (now < end)
+            {
+                // Release everything due
+                std::int64_t earliest_release = NEVER;
+                for (std::size_t i = 0; i < tasks_.size(); i++)
+                {
+                    while (next_release[i] <= now)
+                    {
+                        pending[i].push_back(next_release[i]);
+                        result.tasks[i].jobs++;
+                        next_release[i] += tasks_[i].period.count();
+                    }
+                    earliest_release = std::min(earliest_release, next_release[i]);
+                }
+
+                // Highest priority first, oldest job first among equals
+                std::size_t selected = tasks_.size();
+                for (std::size_t i = 0; i < tasks_.size(); i++)
+                {
+                    if (pending[i].empty())
+                    {
+                        continue;
+                    }
+                    if (selected == tasks_.size() ||
+                        tasks_[i].priority > tasks_[selected].priority ||
+                        (tasks_[i].priority == tasks_[selected].priority && pending[i].front() < pending[selected].front()))
+                    {
+                        selected = i;
+                    }
+                }
+
+                if (selected == tasks_.size())
+                {
+                    // Idle until the next release, serving interrupts meanwhile
+                    now = std::max(earliest_release, serviceInterrupts(now, earliest_release));
+                    continue;
+                }
+
+                std::int64_t release = pending[selected].front();
+                pending[selected].pop_front();
+                auto &counters = result.tasks[selected];
+
+                std::int64_t demand = config_.dispatch_overhead.count() +
+                                      tasks_[selected].execution_time.sample(rng).count();
+                bool faulted = config_.fault_probability > 0.0 && unit(rng) < config_.fault_probability;
+                if (faulted)
+                {
+                    // Aborted somewhere in the job, then recovered
+                    demand = static_cast<std::int64_t>(unit(rng) * static_cast<double>(demand)) +
+                             config_.fault_recovery_time.count();
+                }
+                result.busy_us += demand;
+
+                // Interrupts arriving while the job runs stretch its completion
+                std::int64_t completion = now + demand;
+                while (next_interrupt < completion && next_interrupt < end)
+                {
+                    std::int64_t service = interruptServiceTime(rng);
+                    completion += service;
+                    result.busy_us += service;
+                    result.interrupts++;
+                    next_interrupt += std::max<std::int64_t>(1, static_cast<std::int64_t>(interarrival(rng)));
+                }
+                now = completion;
+
+                std::int64_t response = completion - release;
+                if (faulted)
+                {
+                    counters.faults++;
+                    counters.misses++;
+                }
+                else
+                {
+                    counters.response.add(static_cast<std::uint64_t>(response));
+                    if (response > deadlineOf(selected))
+                    {
+                        counters.misses++;
+                    }
+                }
+            }
+
+            // Jobs still waiting whose deadline has already passed cannot finish in time
+            for (std::size_t i = 0; i < tasks_.size(); i++)
+            {
+                for (std::int64_t release : pending[i])
+                {
+                    if (release + deadlineOf(i) < now)
+                    {
+                        result.tasks[i].misses++;
+                    }
+                    else
+                    {
+                        result.tasks[i].jobs--; // Outcome unknown, not counted
+                    }
+                }
+            }
+
+            // Work spilling past the horizon is not part of this run's window
+            result.busy_us = std::min<std::uint64_t>(result.busy_us, static_cast<std::uint64_t>(end));
+            return result;
+        }
+
+        SimulationResult ScheduleSimulator::run() const
+        {
+            auto wall_start = std::chrono::steady_clock::now();
+
+            SimulationResult result;
+            result.runs = config_.runs;
+            result.seed = config_.seed;
+
+            unsigned int threads = config_.threads > 0 ? config_.threads : std::thread::hardware_concurrency();
+            threads = std::max(1u, threads);
+            threads = static_cast<unsigned int>(std::min<std::size_t>(threads, std::max<std::size_t>(1, config_.runs)));
+            result.threads = threads;
+
+            // Runs are claimed dynamically and folded into per-worker totals,
+            // so memory does not grow with the run count. Every total is a
+            // sum or a maximum, so the result is the same for any thread count.
+            struct Totals
+            {
+                std::vector<RunResult::TaskCounters> tasks;
+                std::vector<std::size_t> runs_with_miss;
+                std::uint64_t interrupts = 0;
+                std::uint64_t busy_us = 0;
+            };
+            std::vector<Totals> partials(threads);
+            std::atomic<std::size_t> next_run{0};
+            auto worker = [&](Totals &totals)
+            {
+                totals.tasks.resize(tasks_.size());
+                totals.runs_with_miss.assign(tasks_.size(), 0);
+                for (std::size_t index = next_run.fetch_add(1); index < config_.runs; index = next_run.fetch_add(1))
+                {
+                    RunResult run = simulateRun(index);
+                    totals.interrupts += run.interrupts;
+                    totals.busy_us += run.busy_us;
+                    for (std::size_t i = 0; i < tasks_.size(); i++)
+                    {
+                        totals.tasks[i].jobs += run.tasks[i].jobs;
+                        totals.tasks[i].misses += run.tasks[i].misses;
+                        totals.tasks[i].faults += run.tasks[i].faults;
+                        totals.tasks[i].response.merge(run.tasks[i].response);
+                        if (run.tasks[i].misses > 0)
+                        {
+                            totals.runs_with_miss[i]++;
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (unsigned int i = 1; i < threads; i++)
+            {
+                workers.emplace_back(worker, std::ref(partials[i]));
+            }
+            worker(partials[0]);
+            for (auto &thread : workers)
+            {
+                thread.join();
+            }
+
+            Totals &totals = partials[0];
+            for (std::size_t worker_index = 1; worker_index < partials.size(); worker_index++)
+            {
+                const Totals &partial = partials[worker_index];
+                totals.interrupts += partial.interrupts;
+                totals.busy_us += partial.busy_us;
+                for (std::size_t i = 0; i < tasks_.size(); i++)
+                {
+                    totals.tasks[i].jobs += partial.tasks[i].jobs;
+                    totals.tasks[i].misses += partial.tasks[i].misses;
+                    totals.tasks[i].faults += partial.tasks[i].faults;
+                    totals.tasks[i].response.merge(partial.tasks[i].response);
+                    totals.runs_with_miss[i] += partial.runs_with_miss[i];
+                }
+            }
+            result.interrupts = totals.interrupts;
+            std::uint64_t busy_us = totals.busy_us;
+
+            if (config_.runs > 0 && config_.duration.count() > 0)
+            {
+                result.average_utilization = 100.0 * static_cast<double>(busy_us) /
+                                             (static_cast<double>(config_.duration.count()) * static_cast<double>(config_.runs));
+            }
+
+            for (std::size_t i = 0; i < tasks_.size(); i++)
+            {
+                TaskSimulationResult task;
+                task.name = tasks_[i].name;
+                task.jobs = totals.tasks[i].jobs;
+                task.deadline_misses = totals.tasks[i].misses;
+                task.faults = totals.tasks[i].faults;
+                task.miss_probability = task.jobs > 0 ? static_cast<double>(task.deadline_misses) / task.jobs : 0.0;
+                task.run_miss_probability = config_.runs > 0 ? static_cast<double>(totals.runs_with_miss[i]) / config_.runs : 0.0;
+
+                const auto &response = totals.tasks[i].response;
+                task.response_mean = std::chrono::microseconds(response.mean());
+                task.response_p50 = std::chrono::microseconds(response.percentile(0.5));
+                task.response_p90 = std::chrono::microseconds(response.percentile(0.9));
+                task.response_p99 = std::chrono::microseconds(response.percentile(0.99));
+                task.response_p999 = std::chrono::microseconds(response.percentile(0.999));
+                task.response_max = std::chrono::microseconds(response.max());
+                result.tasks.push_back(task);
+            }
+
+            result.wall_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - wall_start);
+            return result;
+        }
+
+        bool ScheduleSimulator::writeResults(const SimulationResult &result, const std::string &filename)
+        {
+            std::ofstream file(filename, std::ios::out | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "Error: Could not open simulation results file: " << filename << std::endl;
+                return false;
+            }
+
+            file << "TaskName,Jobs,DeadlineMisses,Faults,MissProbability,RunMissProbability,"
+                 << "ResponseMeanUs,ResponseP50Us,ResponseP90Us,ResponseP99Us,ResponseP999Us,ResponseMaxUs" << std::endl;
+            for (const auto &task : result.tasks)
+            {
+                file << task.name << ","
+                     << task.jobs << ","
+                     << task.deadline_misses << ","
+                     << task.faults << ","
+                     << task.miss_probability << ","
+                     << task.run_miss_probability << ","
+                     << task.response_mean.count() << ","
+                     << task.response_p50.count() << ","
+                     << task.response_p90.count() << ","
+                     << task.response_p99.count() << ","
+                     << task.response_p999.count() << ","
+                     << task.response_max.count() << std::endl;
+            }
+
+            return true;
+        }
+
+    } // namespace util
+} // namespace edurtos
@@ -1,4 +1,5 @@
 #include "../../include/util/scheduler_logger.hpp"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
@@ -44,6 +45,7 @@ namespace edurtos
         {
             if (!is_running_.exchange(true))
             {
+                subscription_ = scheduler_.getEventBus().subscribe(EVENT_QUEUE_CAPACITY);
                 logging_thread_ = std::thread(&SchedulerLogger::loggingLoop, this);
             }
         }
@@ -56,6 +58,10 @@ namespace edurtos
                 {
                     logging_thread_.join();
                 }
+
+                logTransitions();
+                scheduler_.getEventBus().unsubscribe(subscription_);
+                subscription_.reset();
                 flush();
             }
         }
@@ -68,13 +74,17 @@ namespace edurtos
         void SchedulerLogger::writeHeader()
         {
             std::lock_guard<std::mutex> lock(file_mutex_);
-            log_file_ << "Timestamp,EventType,TaskName,TaskState,Priority,DeadlineMs,DeadlinePercent,ExecutionCount,MissCount,AvgExecTimeMs,CPUUtilization" << std::endl;
+            log_file_ << "Timestamp,EventType,TaskName,TaskState,Priority,DeadlineMs,DeadlinePercent,ExecutionCount,MissCount,AvgExecTimeMs,CPUUtilization,AvgCpuTimeMs,Instructions,Cycles,CacheMisses,BranchMisses,TaskClockNs" << std::endl;
             log_file_.flush();
         }
 
         std::string SchedulerLogger::getCurrentTimestamp() const
         {
-            auto now = std::chrono::system_clock::now();
+            return formatTimestamp(std::chrono::system_clock::now());
+        }
+
+        std::string SchedulerLogger::formatTimestamp(std::chrono::system_clock::time_point now)
+        {
             auto now_time_t = std::chrono::system_clock::to_time_t(now);
             auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                               now.time_since_epoch()) %
@@ -100,14 +110,20 @@ namespace edurtos
 
         void SchedulerLogger::logSchedulerState()
         {
-            auto &tasks = scheduler_.getAllTasks();
-            auto current_task = scheduler_.getCurrentTask();
-            float cpu_utilization = scheduler_.getCpuUtilization();
+            auto snapshot = scheduler_.snapshot();
+            const TaskSnapshot *current_task = snapshot->getCurrentTask();
+            float cpu_utilization = snapshot->cpu_utilization;
 
             // Log current state for each task
-            for (const auto &task : tasks)
+            for (const auto &task : snapshot->tasks)
             {
-                logTaskState(task, task == current_task ? "RUNNING" : "STATE_UPDATE");
+                logTaskState(task, &task == current_task ? "RUNNING" : "STATE_UPDATE");
+            }
+
+            // Log the controller output once per control step
+            if (snapshot->feedback_enabled)
+            {
+                logFeedbackControl(snapshot->feedback);
             }
 
             // Log CPU utilization
@@ -118,62 +134,158 @@ namespace edurtos
                       << std::endl;
         }
 
-        void SchedulerLogger::logTaskState(const TaskPtr &task, const std::string &event)
+        void SchedulerLogger::logTaskState(const TaskSnapshot &task, const std::string &event)
         {
-            std::string task_state;
-            switch (task->getState())
+            float avg_exec_ms = task.statistics.average_execution_time.count() / 1000.0f;
+            float avg_cpu_ms = task.statistics.average_cpu_time.count() / 1000.0f;
+            const auto &perf = task.statistics.perf_counters;
+
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            log_file_ << getCurrentTimestamp() << ","
+                      << event << ","
+                      << task.name << ","
+                      << taskStateName(task.state) << ","
+                      << static_cast<int>(task.dynamic_priority) << ","
+                      << task.deadline.count() << ","
+                      << std::fixed << std::setprecision(2) << task.deadline_percent << ","
+                      << task.statistics.execution_count << ","
+                      << task.statistics.deadline_misses << ","
+                      << std::fixed << std::setprecision(3) << avg_exec_ms << ",,"
+                      << avg_cpu_ms << ","
+                      << perf.instructions << ","
+                      << perf.cycles << ","
+                      << perf.cache_misses << ","
+                      << perf.branch_misses << ","
+                      << perf.task_clock_ns
+                      << std::endl;
+        }
+
+        void SchedulerLogger::logFeedbackControl(const FeedbackSample &sample)
+        {
+            if (sample.timestamp == last_feedback_sample_)
             {
-            case TaskState::READY:
-                task_state = "READY";
-                break;
-            case TaskState::RUNNING:
-                task_state = "RUNNING";
-                break;
-            case TaskState::BLOCKED:
-                task_state = "BLOCKED";
-                break;
-            case TaskState::SUSPENDED:
-                task_state = "SUSPENDED";
-                break;
-            case TaskState::TERMINATED:
-                task_state = "TERMINATED";
-                break;
-            default:
-                task_state = "UNKNOWN";
-                break;
+                return;
             }
+            last_feedback_sample_ = sample.timestamp;
 
-            float deadline_percent = 0.0f;
-            if (task->getDeadline().count() > 0)
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(4)
+               << "utilization=" << sample.measured_utilization
+               << ";miss_ratio=" << sample.measured_miss_ratio
+               << ";utilization_output=" << sample.utilization_output
+               << ";miss_output=" << sample.miss_output
+               << ";rate_scale=" << sample.rate_scale;
+
+            logEvent("FEEDBACK_CONTROL", ss.str());
+        }
+
+        void SchedulerLogger::loggingLoop()
+        {
+            auto next_state_log = std::chrono::steady_clock::now();
+            while (is_running_)
+            {
+                // Periodic statistics rows
+                auto now = std::chrono::steady_clock::now();
+                if (now >= next_state_log)
+                {
+                    logSchedulerState();
+                    next_state_log = now + logging_interval_;
+                }
+
+                // Transitions are written as they arrive, a batch at a time
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_state_log - now);
+                subscription_->waitForEvents(std::max(wait, std::chrono::milliseconds(1)), EVENT_BATCH_SIZE);
+                logTransitions();
+            }
+        }
+
+        void SchedulerLogger::logTransitions()
+        {
+            if (!subscription_)
             {
-                deadline_percent = 100.0f *
-                                   task->getStatistics().deadline_counter.count() /
-                                   task->getDeadline().count();
+                return;
             }
 
-            float avg_exec_ms = task->getStatistics().average_execution_time.count() / 1000.0f;
+            event_buffer_.clear();
+            subscription_->poll(event_buffer_);
+
+            std::uint64_t dropped = subscription_->getDroppedCount();
+            if (dropped != reported_drops_)
+            {
+                logEvent("EVENTS_DROPPED", std::to_string(dropped - reported_drops_));
+                reported_drops_ = dropped;
+            }
+
+            if (event_buffer_.empty())
+            {
+                return;
+            }
+
+            // Event times are steady_clock; shift them onto the wall clock
+            auto steady_now = std::chrono::steady_clock::now();
+            auto system_now = std::chrono::system_clock::now();
+            auto snapshot = scheduler_.snapshot();
 
             std::lock_guard<std::mutex> lock(file_mutex_);
-            log_file_ << getCurrentTimestamp() << ","
-                      << event << ","
-                      << task->getName() << ","
-                      << task_state << ","
-                      << static_cast<int>(task->getDynamicPriority()) << ","
-                      << task->getDeadline().count() << ","
-                      << std::fixed << std::setprecision(2) << deadline_percent << ","
-                      << task->getStatistics().execution_count << ","
-                      << task->getStatistics().deadline_misses << ","
-                      << std::fixed << std::setprecision(3) << avg_exec_ms << ","
-                      << std::endl;
+            if (!log_file_.is_open())
+                return;
+
+            for (const auto &event : event_buffer_)
+            {
+                auto age = std::chrono::duration_cast<std::chrono::system_clock::duration>(steady_now - event.getTimestamp());
+                const TaskSnapshot *task = snapshot->findTask(event.task_id);
+
+                log_file_ << formatTimestamp(system_now - age) << ","
+                          << "STATE_CHANGE,";
+                if (task)
+                {
+                    log_file_ << task->name;
+                }
+                else
+                {
+                    log_file_ << "task#" << event.task_id;
+                }
+                log_file_ << "," << taskStateName(event.to) << '\n'; // Flushed with the next state row
+            }
         }
 
-        void SchedulerLogger::loggingLoop()
+        bool SchedulerLogger::writeWcetReport(const std::string &filename, double exceedance_probability)
         {
-            while (is_running_)
+            std::ofstream report(filename, std::ios::out | std::ios::trunc);
+            if (!report.is_open())
+            {
+                std::cerr << "Error: Could not open WCET report file: " << filename << std::endl;
+                return false;
+            }
+
+            report << "TaskName,Samples,PeriodMs,MaxExecUs,P50Us,P90Us,P99Us,GumbelLocationUs,GumbelScaleUs,ExceedanceProbability,pWCETUs,UtilizationPercent" << std::endl;
+
+            for (const auto &task : scheduler_.getAllTasks())
             {
-                logSchedulerState();
-                std::this_thread::sleep_for(logging_interval_);
+                auto estimate = task->getWcetEstimate(exceedance_probability);
+
+                float utilization = 0.0f;
+                if (task->getPeriod().count() > 0)
+                {
+                    utilization = 100.0f * estimate.probabilistic_wcet.count() /
+                                  std::chrono::duration_cast<std::chrono::microseconds>(task->getPeriod()).count();
+                }
+
+                report << task->getName() << ","
+                       << estimate.samples << ","
+                       << task->getPeriod().count() << ","
+                       << estimate.observed_max.count() << ","
+                       << estimate.p50.count() << ","
+                       << estimate.p90.count() << ","
+                       << estimate.p99.count() << ","
+                       << std::fixed << std::setprecision(2) << estimate.gumbel_location_us << ","
+                       << estimate.gumbel_scale_us << ","
+                       << std::scientific << exceedance_probability << ","
+                       << estimate.probabilistic_wcet.count() << ","
+                       << std::fixed << std::setprecision(2) << utilization << std::endl;
             }
+
+            return true;
         }
 
         void SchedulerLogger::flush()
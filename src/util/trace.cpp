@@ -0,0 +1,111 @@
+#include "../../include/util/trace.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace edurtos
+{
+    namespace util
+    {
+
+        Tracer &Tracer::getInstance()
+        {
+            static Tracer instance;
+            return instance;
+        }
+
+        void Tracer::enable(TraceCategory category)
+        {
+            enabled_mask_.fetch_or(static_cast<std::uint32_t>(category));
+        }
+
+        void Tracer::disable(TraceCategory category)
+        {
+            enabled_mask_.fetch_and(~static_cast<std::uint32_t>(category));
+        }
+
+        std::uint64_t Tracer::now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        std::size_t Tracer::drain(std::vector<TraceRecord> &out)
+        {
+            // Writers never block, but concurrent readers would race on tail_
+            static std::mutex drain_mutex;
+            std::lock_guard<std::mutex> lock(drain_mutex);
+
+            std::uint64_t head = head_.load(std::memory_order_acquire);
+
+            // Records older than one ring length have been overwritten
+            if (head - tail_ > RING_SIZE)
+            {
+                dropped_ += head - tail_ - RING_SIZE;
+                tail_ = head - RING_SIZE;
+            }
+
+            std::size_t drained = 0;
+            for (; tail_ < head; tail_++)
+            {
+                const Slot &slot = ring_[tail_ & (RING_SIZE - 1)];
+
+                if (slot.marker.load(std::memory_order_acquire) != tail_ * 2 + 2)
+                {
+                    // Still being written, or already overwritten by a newer record
+                    dropped_++;
+                    continue;
+                }
+
+                TraceRecord record = slot.record;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.marker.load(std::memory_order_relaxed) != tail_ * 2 + 2)
+                {
+                    dropped_++;
+                    continue;
+                }
+
+                out.push_back(record);
+                drained++;
+            }
+
+            return drained;
+        }
+
+        bool Tracer::writeToFile(const std::string &filename)
+        {
+            std::ofstream file(filename, std::ios::out | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "Error: Could not open trace file: " << filename << std::endl;
+                return false;
+            }
+
+            std::vector<TraceRecord> records;
+            drain(records);
+
+            file << "TimestampNs,Sequence,Provider,Name,Arg0,Arg1,Arg2,Arg3" << std::endl;
+            for (const auto &record : records)
+            {
+                file << record.timestamp_ns << ","
+                     << record.sequence << ","
+                     << record.provider << ","
+                     << record.name;
+                for (std::size_t i = 0; i < record.args.size(); i++)
+                {
+                    file << ",";
+                    if (i < record.arg_count)
+                    {
+                        file << record.args[i];
+                    }
+                }
+                file << std::endl;
+            }
+
+            return true;
+        }
+
+    } // namespace util
+} // namespace edurtos